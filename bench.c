@@ -0,0 +1,493 @@
+/////////////////////////////////
+// Header comment place holder //
+/////////////////////////////////
+
+#include "bench_util.h"
+#include "flat_sparse_hashtable.h"
+#include "node_sparse_hashtable.h"
+#include <unistd.h>
+
+/* Defaults of the command line options */
+#define BENCH_DEF_OPS    (1 << 20)
+#define BENCH_DEF_REPS   11
+#define BENCH_DEF_WARMUP 2
+#define BENCH_DEF_SEED   0x5eed5eedULL
+
+/* **** bench_state_t ****
+ *
+ * Keys and tables shared by the scenarios. The keys are generated once from
+ * the seed, so every repetition (and every run with that seed) sees the same ones.
+ */
+typedef struct bench_state_struct
+{
+    size_t n;
+    uint64_t seed;
+
+    /* Layout of the flat keys and order of the hits */
+    bench_keys_t key_space;
+    uint64_t key_param;
+    bench_access_t access;
+
+    /* Flat keys - Insertion order, hits (with the access pattern), deletes (each key once) and keys that never exist */
+    uint64_t *int_keys;
+    uint64_t *int_lookup;
+    uint64_t *int_erase;
+    uint64_t *int_miss;
+
+    /* Node keys - Same as above, stored in a single arena */
+    char **str_keys;
+    char **str_lookup;
+    char **str_erase;
+    char **str_miss;
+    char *arena;
+
+    flat_hashtable_t *flat;
+    node_hashtable_t *node;
+
+    /* Per operation latencies are recorded here if set */
+    bench_hist_t *hist;
+} bench_state_t;
+
+/* **** bench_scenario_t ****
+ *
+ * Only run is timed. Returns the number of successful operations,
+ * which has to be either all or none of them (expect_all).
+ */
+typedef struct bench_scenario_struct
+{
+    const char *name;
+    void (*setup)(bench_state_t *st);
+    size_t (*run)(bench_state_t *st);
+    void (*teardown)(bench_state_t *st);
+    int expect_all;
+} bench_scenario_t;
+
+/* Counts a successful operation - Also times it if the latencies are recorded */
+#define BENCH_OP(st, done, op)                                   \
+    do {                                                         \
+        if((st)->hist)                                           \
+        {                                                        \
+            const uint64_t _start = bench_cycles();              \
+            done += (op);                                        \
+            bench_hist_record((st)->hist, bench_cycles() - _start);\
+        }                                                        \
+        else                                                     \
+            done += (op);                                        \
+    } while(0)
+
+/* ---- Callbacks of the node tables ---- */
+
+static int bench_comp(const void *a, const void *b)
+{
+    return !strcmp(a, b);
+}
+
+static size_t bench_hash(const void *key)
+{
+    return strlen(key);
+}
+
+static void bench_destruct(void *entry, void *key)
+{
+}
+
+/* ---- Key generation ---- */
+
+static void bench_gen_keys(bench_state_t *st)
+{
+    const size_t n = st->n, max_len = BENCH_STR_MAX_LEN;
+    size_t *idx = malloc(n * sizeof(size_t));
+    uint64_t rng = st->seed;
+
+    st->int_keys = malloc(n * sizeof(uint64_t));
+    st->int_lookup = malloc(n * sizeof(uint64_t));
+    st->int_erase = malloc(n * sizeof(uint64_t));
+    st->int_miss = malloc(n * sizeof(uint64_t));
+    st->str_keys = malloc(n * sizeof(char *));
+    st->str_lookup = malloc(n * sizeof(char *));
+    st->str_erase = malloc(n * sizeof(char *));
+    st->str_miss = malloc(n * sizeof(char *));
+    st->arena = malloc(2 * n * max_len);
+
+    bench_gen_int_keys(st->int_keys, st->int_miss, n, st->key_space, st->key_param, &rng);
+
+    /* Misses start with a character that the keys never have */
+    for(size_t i = 0; i < n; i++)
+    {
+        st->str_keys[i] = &st->arena[i * max_len];
+        st->str_miss[i] = &st->arena[(n + i) * max_len];
+        bench_gen_str(st->str_keys[i], i, &rng, 0);
+        bench_gen_str(st->str_miss[i], i, &rng, '#');
+    }
+
+    /* Both variants request the same key indexes */
+    bench_gen_access(idx, n, n, &st->access, &rng);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        st->int_lookup[i] = st->int_keys[idx[i]];
+        st->str_lookup[i] = st->str_keys[idx[i]];
+    }
+
+    memcpy(st->int_erase, st->int_keys, n * sizeof(uint64_t));
+    memcpy(st->str_erase, st->str_keys, n * sizeof(char *));
+    bench_shuffle(st->int_erase, n, sizeof(uint64_t), &rng);
+    bench_shuffle(st->str_erase, n, sizeof(char *), &rng);
+
+    free(idx);
+}
+
+static void bench_free_keys(bench_state_t *st)
+{
+    free(st->int_keys);
+    free(st->int_lookup);
+    free(st->int_erase);
+    free(st->int_miss);
+    free(st->str_keys);
+    free(st->str_lookup);
+    free(st->str_erase);
+    free(st->str_miss);
+    free(st->arena);
+}
+
+/* ---- Flat scenarios (8 byte keys and entries) ---- */
+
+static void flat_setup_empty(bench_state_t *st)
+{
+    int err;
+
+    st->flat = ht_flat_create(1, sizeof(uint64_t), sizeof(uint64_t), &err);
+    ht_flat_reseed(st->flat, st->seed);
+}
+
+static void flat_setup_reserved(bench_state_t *st)
+{
+    int err;
+
+    st->flat = ht_flat_create(st->n, sizeof(uint64_t), sizeof(uint64_t), &err);
+    ht_flat_reseed(st->flat, st->seed);
+}
+
+static void flat_setup_full(bench_state_t *st)
+{
+    int err;
+
+    flat_setup_reserved(st);
+
+    for(size_t i = 0; i < st->n; i++)
+        ht_flat_insert(st->flat, &st->int_keys[i], &st->int_keys[i], &err);
+}
+
+static void flat_teardown(bench_state_t *st)
+{
+    ht_flat_free(st->flat);
+}
+
+static size_t flat_run_insert(bench_state_t *st)
+{
+    int err;
+    size_t done = 0;
+
+    for(size_t i = 0; i < st->n; i++)
+        BENCH_OP(st, done, !ht_flat_insert(st->flat, &st->int_keys[i], &st->int_keys[i], &err) && !err);
+
+    return done;
+}
+
+static size_t flat_run_hit(bench_state_t *st)
+{
+    size_t done = 0;
+
+    for(size_t i = 0; i < st->n; i++)
+        BENCH_OP(st, done, ht_flat_search(st->flat, &st->int_lookup[i]) != NULL);
+
+    return done;
+}
+
+static size_t flat_run_miss(bench_state_t *st)
+{
+    size_t done = 0;
+
+    for(size_t i = 0; i < st->n; i++)
+        BENCH_OP(st, done, ht_flat_search(st->flat, &st->int_miss[i]) != NULL);
+
+    return done;
+}
+
+static size_t flat_run_delete(bench_state_t *st)
+{
+    size_t done = 0;
+
+    for(size_t i = 0; i < st->n; i++)
+        BENCH_OP(st, done, !ht_flat_delete(st->flat, &st->int_erase[i]));
+
+    return done;
+}
+
+/* ---- Node scenarios (8 to 31 byte strings) ---- */
+
+static void node_setup_empty(bench_state_t *st)
+{
+    int err;
+
+    st->node = ht_node_create(1, bench_comp, bench_destruct, bench_hash, &err);
+}
+
+static void node_setup_reserved(bench_state_t *st)
+{
+    int err;
+
+    st->node = ht_node_create(st->n, bench_comp, bench_destruct, bench_hash, &err);
+}
+
+static void node_setup_full(bench_state_t *st)
+{
+    int err;
+
+    node_setup_reserved(st);
+
+    for(size_t i = 0; i < st->n; i++)
+        ht_node_insert(st->node, st->str_keys[i], st->str_keys[i], &err);
+}
+
+static void node_teardown(bench_state_t *st)
+{
+    ht_node_free(st->node);
+}
+
+static size_t node_run_insert(bench_state_t *st)
+{
+    int err;
+    size_t done = 0;
+
+    for(size_t i = 0; i < st->n; i++)
+        BENCH_OP(st, done, !ht_node_insert(st->node, st->str_keys[i], st->str_keys[i], &err) && !err);
+
+    return done;
+}
+
+static size_t node_run_hit(bench_state_t *st)
+{
+    size_t done = 0;
+
+    for(size_t i = 0; i < st->n; i++)
+        BENCH_OP(st, done, ht_node_search(st->node, st->str_lookup[i]) != NULL);
+
+    return done;
+}
+
+static size_t node_run_miss(bench_state_t *st)
+{
+    size_t done = 0;
+
+    for(size_t i = 0; i < st->n; i++)
+        BENCH_OP(st, done, ht_node_search(st->node, st->str_miss[i]) != NULL);
+
+    return done;
+}
+
+static size_t node_run_delete(bench_state_t *st)
+{
+    size_t done = 0;
+
+    for(size_t i = 0; i < st->n; i++)
+        BENCH_OP(st, done, !ht_node_delete(st->node, st->str_erase[i]));
+
+    return done;
+}
+
+static const bench_scenario_t scenarios[] =
+{
+    {"flat_insert",          flat_setup_empty,    flat_run_insert, flat_teardown, 1},
+    {"flat_insert_reserved", flat_setup_reserved, flat_run_insert, flat_teardown, 1},
+    {"flat_search_hit",      flat_setup_full,     flat_run_hit,    flat_teardown, 1},
+    {"flat_search_miss",     flat_setup_full,     flat_run_miss,   flat_teardown, 0},
+    {"flat_delete",          flat_setup_full,     flat_run_delete, flat_teardown, 1},
+    {"node_insert",          node_setup_empty,    node_run_insert, node_teardown, 1},
+    {"node_insert_reserved", node_setup_reserved, node_run_insert, node_teardown, 1},
+    {"node_search_hit",      node_setup_full,     node_run_hit,    node_teardown, 1},
+    {"node_search_miss",     node_setup_full,     node_run_miss,   node_teardown, 0},
+    {"node_delete",          node_setup_full,     node_run_delete, node_teardown, 1},
+};
+
+/* Runs a scenario once - Only the run is timed (total ns and cycles) and counted (if perf is set) */
+static void bench_pass(const bench_scenario_t *sc, bench_state_t *st, bench_perf_t *perf, uint64_t *ns, uint64_t *cycles)
+{
+    sc->setup(st);
+
+    if(perf)
+        bench_perf_enable(perf);
+
+    const uint64_t t_start = bench_now_ns(), c_start = bench_cycles();
+    const size_t done = sc->run(st);
+    const uint64_t c_end = bench_cycles(), t_end = bench_now_ns();
+
+    if(perf)
+        bench_perf_disable(perf);
+
+    sc->teardown(st);
+
+    /* A wrong count means the scenario measured something else */
+    if(done != (sc->expect_all ? st->n : 0))
+    {
+        fprintf(stderr, "%s: %zu of %zu operations succeeded | Exiting...\n", sc->name, done, st->n);
+        exit(1);
+    }
+
+    *ns = t_end - t_start;
+    *cycles = c_end - c_start;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-n ops] [-r reps] [-w warmup] [-c cpu (-1 no pinning)] [-s seed] "
+            "[-f text|csv|json] [-t scenario filter] [-l (latencies)] [-H histogram dump file] [-p (hardware counters)]\n"
+            "       [-K random|sequential|clustered[:run]|strided[:stride]] [-a shuffled|uniform|zipf[:theta]|hot[:keys%%:access%%]]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    bench_state_t st = {.n = BENCH_DEF_OPS, .seed = BENCH_DEF_SEED, .key_space = BENCH_KEYS_RANDOM,
+                        .access = {.type = BENCH_ACCESS_SHUFFLED}};
+    const char *keys_spec = "random", *access_spec = "shuffled";
+    bench_format_t fmt = BENCH_FORMAT_TEXT;
+    size_t reps = BENCH_DEF_REPS, warmup = BENCH_DEF_WARMUP;
+    const char *filter = NULL, *dump_path = NULL;
+    int cpu = 0, opt, first = 1, latency = 0, counters = 0;
+    FILE *dump = NULL;
+
+    while((opt = getopt(argc, argv, "n:r:w:c:s:f:t:lH:pK:a:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': st.n = strtoull(optarg, NULL, 0); break;
+            case 'r': reps = strtoull(optarg, NULL, 0); break;
+            case 'w': warmup = strtoull(optarg, NULL, 0); break;
+            case 'c': cpu = atoi(optarg); break;
+            case 's': st.seed = strtoull(optarg, NULL, 0); break;
+            case 't': filter = optarg; break;
+            case 'l': latency = 1; break;
+            case 'p': counters = 1; break;
+            case 'K': keys_spec = optarg; break;
+            case 'a': access_spec = optarg; break;
+            case 'H': dump_path = optarg; latency = 1; break;
+            case 'f':
+                fmt = !strcmp(optarg, "csv") ? BENCH_FORMAT_CSV : !strcmp(optarg, "json") ? BENCH_FORMAT_JSON : BENCH_FORMAT_TEXT;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if(!st.n || !reps || bench_parse_keys(keys_spec, &st.key_space, &st.key_param) || bench_parse_access(access_spec, &st.access))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    /* Scheduling noise - Warn but keep running if the cpu is not available */
+    if(bench_pin_cpu(cpu))
+    {
+        fprintf(stderr, "Could not pin to cpu %d - Running unpinned\n", cpu);
+        cpu = -1;
+    }
+
+    if(dump_path && !(dump = fopen(dump_path, "w")))
+    {
+        fprintf(stderr, "Could not open %s\n", dump_path);
+        return 1;
+    }
+
+    bench_gen_keys(&st);
+
+    /* Latencies are in TSC ticks - Converted with the measured rate */
+    bench_hist_t *hist = malloc(sizeof(bench_hist_t));
+    const double ticks_per_ns = latency ? bench_ticks_per_ns() : 1.0;
+    const uint64_t overhead = latency ? bench_timer_overhead() : 0;
+
+    if(dump)
+        fprintf(dump, "scenario,low_ns,high_ns,count,cumulative_pct\n");
+
+    /* Counters are optional - Not every kernel (or VM) allows them */
+    bench_perf_t perf;
+
+    if(counters && !bench_perf_open(&perf))
+    {
+        fprintf(stderr, "No hardware counters available (check perf_event_paranoid) - Running without them\n");
+        counters = 0;
+    }
+
+    double *ns = malloc(reps * sizeof(double));
+    double *cycles = malloc(reps * sizeof(double));
+
+    bench_report_begin(stdout, fmt, st.seed, cpu, warmup, keys_spec, access_spec);
+
+    for(size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++)
+    {
+        const bench_scenario_t *sc = &scenarios[s];
+        bench_result_t res = {.name = sc->name};
+
+        if(filter && !strstr(sc->name, filter))
+            continue;
+
+        if(counters)
+            bench_perf_reset(&perf);
+
+        for(size_t r = 0; r < warmup + reps; r++)
+        {
+            uint64_t pass_ns, pass_cycles;
+
+            /* Only the measured reps are counted */
+            bench_pass(sc, &st, (counters && r >= warmup) ? &perf : NULL, &pass_ns, &pass_cycles);
+
+            if(r >= warmup)
+            {
+                ns[r - warmup] = (double)pass_ns;
+                cycles[r - warmup] = (double)pass_cycles;
+            }
+        }
+
+        bench_summarize(&res, ns, cycles, reps, st.n);
+
+        if(counters)
+            bench_perf_read(&perf, res.perf, reps * st.n);
+        else
+            for(int i = 0; i < BENCH_PERF_EVENTS; i++)
+                res.perf[i] = -1;
+
+        /* Separate pass for the latencies, so the timer reads do not skew the throughput */
+        if(latency)
+        {
+            uint64_t pass_ns, pass_cycles;
+
+            bench_hist_reset(hist, overhead);
+            st.hist = hist;
+            bench_pass(sc, &st, NULL, &pass_ns, &pass_cycles);
+            st.hist = NULL;
+
+            bench_hist_summarize(&res, hist, ticks_per_ns);
+
+            if(dump)
+                bench_hist_dump(dump, sc->name, hist, ticks_per_ns);
+        }
+
+        bench_report(stdout, fmt, &res, first);
+        first = 0;
+    }
+
+    bench_report_end(stdout, fmt);
+
+    if(dump)
+        fclose(dump);
+
+    if(counters)
+        bench_perf_close(&perf);
+
+    free(hist);
+    free(ns);
+    free(cycles);
+    bench_free_keys(&st);
+
+    return 0;
+}
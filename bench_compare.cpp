@@ -0,0 +1,527 @@
+/////////////////////////////////
+// Header comment place holder //
+/////////////////////////////////
+
+/* Comparison of the Swiss tables against std::unordered_map and two reference tables
+ * (separate chaining and linear probing), with the same keys, payloads and scenarios. */
+
+#include "bench_util.h"
+
+extern "C" {
+#include "flat_sparse_hashtable.h"
+#include "node_sparse_hashtable.h"
+}
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+/* Defaults of the command line options */
+#define COMPARE_DEF_OPS    (1 << 20)
+#define COMPARE_DEF_REPS   5
+#define COMPARE_DEF_WARMUP 1
+#define COMPARE_DEF_SEED   0x5eed5eedULL
+
+/* ---- Reference tables ---- */
+
+/* Murmur3 finalizer - The reference tables use it for the integer keys */
+struct mix64_hash
+{
+    size_t operator()(uint64_t key) const
+    {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        return key ^ (key >> 33);
+    }
+};
+
+/* **** chained_map ****
+ *
+ * Separate chaining - Power of 2 bucket array of singly linked nodes,
+ * doubled when the load factor reaches 1.
+ */
+template<class K, class V, class Hash>
+class chained_map
+{
+    struct node
+    {
+        K key;
+        V value;
+        node *next;
+    };
+
+    std::vector<node *> buckets;
+    size_t count = 0;
+    Hash hash;
+
+    void grow()
+    {
+        std::vector<node *> new_buckets(buckets.size() * 2, nullptr);
+        const size_t mask = new_buckets.size() - 1;
+
+        for(node *head : buckets)
+        {
+            while(head)
+            {
+                node *next = head->next;
+                node **bucket = &new_buckets[hash(head->key) & mask];
+
+                head->next = *bucket;
+                *bucket = head;
+                head = next;
+            }
+        }
+
+        buckets.swap(new_buckets);
+    }
+
+public:
+    chained_map() : buckets(16, nullptr) {}
+
+    ~chained_map()
+    {
+        for(node *head : buckets)
+        {
+            while(head)
+            {
+                node *next = head->next;
+                delete head;
+                head = next;
+            }
+        }
+    }
+
+    V *find(const K &key)
+    {
+        for(node *cur = buckets[hash(key) & (buckets.size() - 1)]; cur; cur = cur->next)
+        {
+            if(cur->key == key)
+                return &cur->value;
+        }
+
+        return nullptr;
+    }
+
+    bool insert(const K &key, const V &value)
+    {
+        if(find(key))
+            return false;
+
+        if(count + 1 > buckets.size())
+            grow();
+
+        node **bucket = &buckets[hash(key) & (buckets.size() - 1)];
+        *bucket = new node{key, value, *bucket};
+        count++;
+
+        return true;
+    }
+
+    bool erase(const K &key)
+    {
+        for(node **link = &buckets[hash(key) & (buckets.size() - 1)]; *link; link = &(*link)->next)
+        {
+            if((*link)->key == key)
+            {
+                node *dead = *link;
+
+                *link = dead->next;
+                delete dead;
+                count--;
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+/* **** linear_map ****
+ *
+ * Open addressing with linear probing over a single slot array (state byte inline),
+ * with tombstones on erase. Rehashed when the used slots (tombstones included) reach 75%.
+ */
+template<class K, class V, class Hash>
+class linear_map
+{
+    enum : uint8_t { SLOT_EMPTY, SLOT_FULL, SLOT_DELETED };
+
+    struct slot
+    {
+        K key;
+        V value;
+        uint8_t state;
+    };
+
+    std::vector<slot> slots;
+    size_t count = 0, used = 0;
+    Hash hash;
+
+    void rehash(size_t new_sz)
+    {
+        std::vector<slot> old(new_sz, slot{K(), V(), SLOT_EMPTY});
+
+        old.swap(slots);
+        count = used = 0;
+
+        for(const slot &s : old)
+        {
+            if(s.state == SLOT_FULL)
+                insert(s.key, s.value);
+        }
+    }
+
+public:
+    linear_map() : slots(16, slot{K(), V(), SLOT_EMPTY}) {}
+
+    V *find(const K &key)
+    {
+        const size_t mask = slots.size() - 1;
+
+        for(size_t i = hash(key) & mask; slots[i].state != SLOT_EMPTY; i = (i + 1) & mask)
+        {
+            if(slots[i].state == SLOT_FULL && slots[i].key == key)
+                return &slots[i].value;
+        }
+
+        return nullptr;
+    }
+
+    bool insert(const K &key, const V &value)
+    {
+        /* Grows only if live entries need it, otherwise cleans the tombstones */
+        if(4 * (used + 1) > 3 * slots.size())
+            rehash((4 * (count + 1) > 2 * slots.size()) ? slots.size() * 2 : slots.size());
+
+        const size_t mask = slots.size() - 1;
+        size_t i = hash(key) & mask, free_slot = SIZE_MAX;
+
+        for(; slots[i].state != SLOT_EMPTY; i = (i + 1) & mask)
+        {
+            if(slots[i].state == SLOT_FULL && slots[i].key == key)
+                return false;
+
+            if(slots[i].state == SLOT_DELETED && free_slot == SIZE_MAX)
+                free_slot = i;
+        }
+
+        if(free_slot == SIZE_MAX)
+        {
+            free_slot = i;
+            used++;
+        }
+
+        slots[free_slot] = slot{key, value, SLOT_FULL};
+        count++;
+
+        return true;
+    }
+
+    bool erase(const K &key)
+    {
+        const size_t mask = slots.size() - 1;
+
+        for(size_t i = hash(key) & mask; slots[i].state != SLOT_EMPTY; i = (i + 1) & mask)
+        {
+            if(slots[i].state == SLOT_FULL && slots[i].key == key)
+            {
+                slots[i].state = SLOT_DELETED;
+                count--;
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+/* ---- Adapters ---- */
+
+template<class K, class V, class Hash = std::hash<K>>
+class std_map
+{
+    std::unordered_map<K, V, Hash> map;
+
+public:
+    V *find(const K &key)
+    {
+        auto it = map.find(key);
+        return (it == map.end()) ? nullptr : &it->second;
+    }
+
+    bool insert(const K &key, const V &value) { return map.emplace(key, value).second; }
+    bool erase(const K &key) { return map.erase(key) == 1; }
+};
+
+/* Flat variant - Keys and payloads are copied in the table */
+class swiss_flat_map
+{
+    flat_hashtable_t *table;
+
+public:
+    swiss_flat_map()
+    {
+        int err;
+        table = ht_flat_create(1, sizeof(uint64_t), sizeof(uint64_t), &err);
+    }
+
+    ~swiss_flat_map() { ht_flat_free(table); }
+
+    uint64_t *find(const uint64_t &key) { return (uint64_t *)ht_flat_search(table, &key); }
+    bool erase(const uint64_t &key) { return !ht_flat_delete(table, &key); }
+
+    bool insert(const uint64_t &key, const uint64_t &value)
+    {
+        int err;
+        return !ht_flat_insert(table, &key, &value, &err) && !err;
+    }
+};
+
+/* Node variant - Holds references, so the keys (NUL terminated) and payloads stay with the caller */
+class swiss_node_map
+{
+    node_hashtable_t *table;
+
+    static int comp(const void *a, const void *b) { return !strcmp((const char *)a, (const char *)b); }
+    static size_t hash(const void *key) { return strlen((const char *)key); }
+    static void destruct(void *entry, void *key) {}
+
+public:
+    swiss_node_map()
+    {
+        int err;
+        table = ht_node_create(1, comp, destruct, hash, &err);
+    }
+
+    ~swiss_node_map() { ht_node_free(table); }
+
+    uint64_t *find(const std::string_view &key) { return (uint64_t *)ht_node_search(table, key.data()); }
+    bool erase(const std::string_view &key) { return !ht_node_delete(table, key.data()); }
+
+    bool insert(const std::string_view &key, const uint64_t &value)
+    {
+        int err;
+        return !ht_node_insert(table, (void *)key.data(), (void *)&value, &err) && !err;
+    }
+};
+
+/* ---- Scenarios ---- */
+
+/* Keys of a run - Payloads are shared, the misses never exist */
+template<class K>
+struct key_set
+{
+    const char *name;
+    std::vector<K> keys, lookup, miss;
+    std::vector<uint64_t> payloads;
+};
+
+/* Result row of one table on one key set - Median ns per operation and memory */
+struct compare_row
+{
+    double insert_ns, hit_ns, miss_ns, delete_ns;
+    double bytes_per_entry;
+};
+
+/* Heap in use, for the memory of a full table (0 where not available) */
+static size_t heap_in_use()
+{
+#ifdef __GLIBC__
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+template<class Map, class K>
+static void fill(Map &map, const key_set<K> &set)
+{
+    for(size_t i = 0; i < set.keys.size(); i++)
+        map.insert(set.keys[i], set.payloads[i]);
+}
+
+/* Median ns per op of a timed step over the reps - The map is built untimed if full is set */
+template<class Map, class K, class Step>
+static double measure(const key_set<K> &set, bool full, size_t reps, size_t warmup, Step step)
+{
+    std::vector<double> ns(reps), cycles(reps);
+    const size_t n = set.keys.size();
+
+    for(size_t r = 0; r < warmup + reps; r++)
+    {
+        Map *map = new Map();
+
+        if(full)
+            fill(*map, set);
+
+        const uint64_t start = bench_now_ns();
+        const size_t done = step(*map);
+        const uint64_t end = bench_now_ns();
+
+        delete map;
+
+        /* Hits, inserts and deletes must all succeed, misses never */
+        if(done != n && done != 0)
+        {
+            fprintf(stderr, "Only %zu of %zu operations succeeded | Exiting...\n", done, n);
+            exit(1);
+        }
+
+        if(r >= warmup)
+            ns[r - warmup] = cycles[r - warmup] = (double)(end - start);
+    }
+
+    bench_result_t res;
+    bench_summarize(&res, ns.data(), cycles.data(), reps, n);
+
+    return res.median_ns;
+}
+
+template<class Map, class K>
+static compare_row run_table(const key_set<K> &set, size_t reps, size_t warmup)
+{
+    compare_row row;
+    const size_t n = set.keys.size();
+
+    row.insert_ns = measure<Map>(set, false, reps, warmup, [&](Map &map) {
+        size_t done = 0;
+        for(size_t i = 0; i < n; i++)
+            done += map.insert(set.keys[i], set.payloads[i]);
+        return done;
+    });
+
+    row.hit_ns = measure<Map>(set, true, reps, warmup, [&](Map &map) {
+        size_t done = 0;
+        for(size_t i = 0; i < n; i++)
+            done += map.find(set.lookup[i]) != nullptr;
+        return done;
+    });
+
+    row.miss_ns = measure<Map>(set, true, reps, warmup, [&](Map &map) {
+        size_t done = 0;
+        for(size_t i = 0; i < n; i++)
+            done += map.find(set.miss[i]) != nullptr;
+        return done;
+    });
+
+    row.delete_ns = measure<Map>(set, true, reps, warmup, [&](Map &map) {
+        size_t done = 0;
+        for(size_t i = 0; i < n; i++)
+            done += map.erase(set.lookup[i]);
+        return done;
+    });
+
+    /* Memory of a full table, keys of the string set excluded (every table references the same) */
+    const size_t before = heap_in_use();
+    Map *map = new Map();
+
+    fill(*map, set);
+    row.bytes_per_entry = (double)(heap_in_use() - before) / n;
+    delete map;
+
+    return row;
+}
+
+static void report_row(bench_format_t fmt, const char *table, const char *keys, size_t n, const compare_row &row)
+{
+    if(fmt == BENCH_FORMAT_CSV)
+        printf("%s,%s,%zu,%.2f,%.2f,%.2f,%.2f,%.1f\n", table, keys, n, row.insert_ns, row.hit_ns,
+               row.miss_ns, row.delete_ns, row.bytes_per_entry);
+    else
+        printf("%-20s %-6s %10.2f %10.2f %10.2f %10.2f %12.1f\n", table, keys, row.insert_ns, row.hit_ns,
+               row.miss_ns, row.delete_ns, row.bytes_per_entry);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-n ops] [-r reps] [-w warmup] [-c cpu (-1 no pinning)] [-s seed] [-f text|csv]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = COMPARE_DEF_OPS, reps = COMPARE_DEF_REPS, warmup = COMPARE_DEF_WARMUP;
+    uint64_t seed = COMPARE_DEF_SEED;
+    bench_format_t fmt = BENCH_FORMAT_TEXT;
+    int cpu = 0, opt;
+
+    while((opt = getopt(argc, argv, "n:r:w:c:s:f:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': n = strtoull(optarg, NULL, 0); break;
+            case 'r': reps = strtoull(optarg, NULL, 0); break;
+            case 'w': warmup = strtoull(optarg, NULL, 0); break;
+            case 'c': cpu = atoi(optarg); break;
+            case 's': seed = strtoull(optarg, NULL, 0); break;
+            case 'f': fmt = !strcmp(optarg, "csv") ? BENCH_FORMAT_CSV : BENCH_FORMAT_TEXT; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if(!n || !reps)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if(bench_pin_cpu(cpu))
+    {
+        fprintf(stderr, "Could not pin to cpu %d - Running unpinned\n", cpu);
+        cpu = -1;
+    }
+
+    /* Same generation as bench - Distinct 64-bit keys and unique strings */
+    uint64_t rng = seed;
+    key_set<uint64_t> ints{"int", {}, {}, {}, {}};
+    key_set<std::string_view> strs{"str", {}, {}, {}, {}};
+    std::vector<char> arena(2 * n * BENCH_STR_MAX_LEN);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        ints.keys.push_back(bench_rand(&rng));
+        ints.miss.push_back(bench_rand(&rng));
+        ints.payloads.push_back(i);
+
+        bench_gen_str(&arena[i * BENCH_STR_MAX_LEN], i, &rng, 0);
+        bench_gen_str(&arena[(n + i) * BENCH_STR_MAX_LEN], i, &rng, '#');
+        strs.keys.emplace_back(&arena[i * BENCH_STR_MAX_LEN]);
+        strs.miss.emplace_back(&arena[(n + i) * BENCH_STR_MAX_LEN]);
+    }
+
+    strs.payloads = ints.payloads;
+    ints.lookup = ints.keys;
+    strs.lookup = strs.keys;
+    bench_shuffle(ints.lookup.data(), n, sizeof(uint64_t), &rng);
+    bench_shuffle(strs.lookup.data(), n, sizeof(std::string_view), &rng);
+
+    if(fmt == BENCH_FORMAT_CSV)
+        printf("table,keys,ops,insert_ns,hit_ns,miss_ns,delete_ns,bytes_per_entry\n");
+    else
+        printf("seed %llu - cpu %d - %zu ops - median ns per op\n%-20s %-6s %10s %10s %10s %10s %12s\n",
+               (unsigned long long)seed, cpu, n, "table", "keys", "insert", "hit", "miss", "delete", "bytes/entry");
+
+    report_row(fmt, "swiss_flat", ints.name, n, run_table<swiss_flat_map>(ints, reps, warmup));
+    report_row(fmt, "std_unordered_map", ints.name, n, run_table<std_map<uint64_t, uint64_t>>(ints, reps, warmup));
+    report_row(fmt, "chained", ints.name, n, run_table<chained_map<uint64_t, uint64_t, mix64_hash>>(ints, reps, warmup));
+    report_row(fmt, "linear_probing", ints.name, n, run_table<linear_map<uint64_t, uint64_t, mix64_hash>>(ints, reps, warmup));
+
+    report_row(fmt, "swiss_node", strs.name, n, run_table<swiss_node_map>(strs, reps, warmup));
+    report_row(fmt, "std_unordered_map", strs.name, n, run_table<std_map<std::string_view, uint64_t>>(strs, reps, warmup));
+    report_row(fmt, "chained", strs.name, n,
+               run_table<chained_map<std::string_view, uint64_t, std::hash<std::string_view>>>(strs, reps, warmup));
+    report_row(fmt, "linear_probing", strs.name, n,
+               run_table<linear_map<std::string_view, uint64_t, std::hash<std::string_view>>>(strs, reps, warmup));
+
+    return 0;
+}
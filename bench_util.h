@@ -0,0 +1,719 @@
+/////////////////////////////////
+// Header comment place holder //
+/////////////////////////////////
+
+#ifndef __BENCH_UTIL_H
+#define __BENCH_UTIL_H
+
+/* Needed for the affinity calls - Include this header first */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+// *** Header Inclusions *** //
+#include <math.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_RDTSC
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BENCH_HAVE_PERF
+#endif
+
+/* Output formats of the reports */
+typedef enum bench_format_enum
+{
+    BENCH_FORMAT_TEXT,
+    BENCH_FORMAT_CSV,
+    BENCH_FORMAT_JSON
+} bench_format_t;
+
+/* Histogram precision - 2^5 sub-buckets per power of 2 (~3% relative error) */
+#define BENCH_HIST_SUB_BITS 5
+#define BENCH_HIST_SUB      (1 << BENCH_HIST_SUB_BITS)
+#define BENCH_HIST_BUCKETS  ((65 - BENCH_HIST_SUB_BITS) << BENCH_HIST_SUB_BITS)
+
+/* **** bench_hist_t ****
+ *
+ * HDR style histogram of per operation latencies (in TSC ticks). Values below
+ * BENCH_HIST_SUB get a bucket each, above that every power of 2 is split in
+ * BENCH_HIST_SUB linear sub-buckets, so the whole 64-bit range fits in a fixed array.
+ * The offset (timer overhead) is subtracted from every recorded value.
+ */
+typedef struct bench_hist_struct
+{
+    uint64_t counts[BENCH_HIST_BUCKETS];
+    uint64_t total;
+    uint64_t max;
+    uint64_t offset;
+} bench_hist_t;
+
+/* Hardware counters - Order of the names and of the values in the results */
+#define BENCH_PERF_EVENTS 6
+
+static const char *const bench_perf_names[BENCH_PERF_EVENTS] =
+{
+    "core_cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"
+};
+
+/* **** bench_perf_t ****
+ *
+ * Counters opened with perf_event_open (user space only). Every counter is a separate
+ * event, so the ones the cpu or the kernel refuse are simply skipped (fd of -1).
+ */
+typedef struct bench_perf_struct
+{
+    int fd[BENCH_PERF_EVENTS];
+} bench_perf_t;
+
+/* **** bench_result_t ****
+ *
+ * Summary of one scenario over all the repetitions (warmup excluded).
+ * Times are per operation, with the cycles being the median of the reps.
+ * Latency percentiles come from a separate recorded pass (0 if not recorded).
+ */
+typedef struct bench_result_struct
+{
+    const char *name;
+    size_t ops;
+    size_t reps;
+
+    double min_ns;
+    double median_ns;
+    double p90_ns;
+    double max_ns;
+    double cycles;
+
+    double lat_p50;
+    double lat_p99;
+    double lat_p999;
+    double lat_max;
+
+    /* Counters per operation over the measured reps (-1 if not counted) */
+    double perf[BENCH_PERF_EVENTS];
+} bench_result_t;
+
+/* ---- Timing ---- */
+
+/* Wall clock in ns - Monotonic, so not affected by time adjustments */
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Reference cycles (TSC) where available, else the monotonic clock in ns */
+static inline uint64_t bench_cycles(void)
+{
+#ifdef BENCH_HAVE_RDTSC
+    return __rdtsc();
+#else
+    return bench_now_ns();
+#endif
+}
+
+/* TSC ticks per ns, measured against the monotonic clock (1 without a TSC) */
+static inline double bench_ticks_per_ns(void)
+{
+#ifdef BENCH_HAVE_RDTSC
+    const uint64_t t_start = bench_now_ns(), c_start = bench_cycles();
+
+    while(bench_now_ns() - t_start < 20000000ULL);
+
+    return (double)(bench_cycles() - c_start) / (bench_now_ns() - t_start);
+#else
+    return 1.0;
+#endif
+}
+
+/* Cost of two back to back timer reads, subtracted from the per operation samples */
+static inline uint64_t bench_timer_overhead(void)
+{
+    uint64_t min = UINT64_MAX;
+
+    for(int i = 0; i < 1000; i++)
+    {
+        const uint64_t start = bench_cycles();
+        const uint64_t delta = bench_cycles() - start;
+
+        min = (delta < min) ? delta : min;
+    }
+
+    return min;
+}
+
+/* ---- Environment ---- */
+
+/* Pins the calling thread to a cpu (negative for no pinning) - Returns 0 on success */
+static inline int bench_pin_cpu(int cpu)
+{
+    cpu_set_t set;
+
+    if(cpu < 0)
+        return 0;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    return sched_setaffinity(0, sizeof(set), &set);
+}
+
+/* Splitmix64 - Deterministic for a given seed, so every run sees the same keys */
+static inline uint64_t bench_rand(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Uniform double in [0, 1) */
+static inline double bench_rand_double(uint64_t *state)
+{
+    return (bench_rand(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* **** bench_zipf_t ****
+ *
+ * Zipfian ranks in [0, n) as YCSB draws them (Gray et al.), where rank 0 is
+ * the most popular one and theta (0 < theta < 1) sets the skew. The zeta
+ * constant is computed once in O(n), every draw is O(1).
+ */
+typedef struct bench_zipf_struct
+{
+    uint64_t n;
+    double theta;
+    double alpha;
+    double zetan;
+    double eta;
+} bench_zipf_t;
+
+static inline void bench_zipf_init(bench_zipf_t *zipf, uint64_t n, double theta)
+{
+    double zeta2 = 1.0 + pow(0.5, theta);
+
+    zipf->n = n;
+    zipf->theta = theta;
+    zipf->zetan = 0;
+
+    for(uint64_t i = 1; i <= n; i++)
+        zipf->zetan += 1.0 / pow((double)i, theta);
+
+    zipf->alpha = 1.0 / (1.0 - theta);
+    zipf->eta = (1.0 - pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zipf->zetan);
+}
+
+static inline uint64_t bench_zipf_next(const bench_zipf_t *zipf, uint64_t *state)
+{
+    const double u = bench_rand_double(state);
+    const double uz = u * zipf->zetan;
+
+    if(uz < 1.0)
+        return 0;
+
+    if(uz < 1.0 + pow(0.5, zipf->theta))
+        return 1;
+
+    const uint64_t rank = (uint64_t)(zipf->n * pow(zipf->eta * u - zipf->eta + 1.0, zipf->alpha));
+
+    return (rank < zipf->n) ? rank : zipf->n - 1;
+}
+
+/* Fisher-Yates shuffle of an array of elsize elements */
+static inline void bench_shuffle(void *array, size_t n, size_t elsize, uint64_t *state)
+{
+    char tmp[64];
+    char *arr = (char *)array;
+
+    for(size_t i = n - 1; i > 0 && elsize <= sizeof(tmp); i--)
+    {
+        size_t j = bench_rand(state) % (i + 1);
+
+        memcpy(tmp, &arr[i * elsize], elsize);
+        memcpy(&arr[i * elsize], &arr[j * elsize], elsize);
+        memcpy(&arr[j * elsize], tmp, elsize);
+    }
+}
+
+/* ---- Key spaces and access patterns ---- */
+
+/* Layout of the integer keys */
+typedef enum bench_keys_enum
+{
+    BENCH_KEYS_RANDOM,     /* Sparse uniform 64-bit identifiers */
+    BENCH_KEYS_SEQUENTIAL, /* 1..n */
+    BENCH_KEYS_CLUSTERED,  /* Runs of param consecutive keys at random bases */
+    BENCH_KEYS_STRIDED     /* Random base plus multiples of param */
+} bench_keys_t;
+
+/* Order in which the keys are requested */
+typedef enum bench_access_enum
+{
+    BENCH_ACCESS_SHUFFLED, /* Every key once, in random order */
+    BENCH_ACCESS_UNIFORM,  /* Uniform with repetitions */
+    BENCH_ACCESS_ZIPFIAN,  /* Zipfian with popular keys scattered over the key space */
+    BENCH_ACCESS_HOTSET    /* hot_access of the requests go to hot_keys of the keys (fractions) */
+} bench_access_type_t;
+
+typedef struct bench_access_struct
+{
+    bench_access_type_t type;
+    double theta;
+    double hot_keys;
+    double hot_access;
+} bench_access_t;
+
+/* Parses "random", "sequential", "clustered[:run]" or "strided[:stride]" - Returns 0 on success */
+static inline int bench_parse_keys(const char *spec, bench_keys_t *keys, uint64_t *param)
+{
+    const char *arg = strchr(spec, ':');
+
+    if(!strncmp(spec, "random", 6))
+        *keys = BENCH_KEYS_RANDOM;
+    else if(!strncmp(spec, "sequential", 10))
+        *keys = BENCH_KEYS_SEQUENTIAL;
+    else if(!strncmp(spec, "clustered", 9))
+        *keys = BENCH_KEYS_CLUSTERED;
+    else if(!strncmp(spec, "strided", 7))
+        *keys = BENCH_KEYS_STRIDED;
+    else
+        return -1;
+
+    *param = arg ? strtoull(arg + 1, NULL, 0) : (*keys == BENCH_KEYS_STRIDED) ? 4096 : 64;
+
+    return (*param && *param <= (1 << 20)) ? 0 : -1;
+}
+
+/* Parses "shuffled", "uniform", "zipf[:theta]" or "hot[:keys%:access%]" - Returns 0 on success */
+static inline int bench_parse_access(const char *spec, bench_access_t *acc)
+{
+    const char *arg = strchr(spec, ':');
+
+    acc->theta = 0.99;
+    acc->hot_keys = 0.01;
+    acc->hot_access = 0.9;
+
+    if(!strncmp(spec, "shuffled", 8))
+        acc->type = BENCH_ACCESS_SHUFFLED;
+    else if(!strncmp(spec, "uniform", 7))
+        acc->type = BENCH_ACCESS_UNIFORM;
+    else if(!strncmp(spec, "zipf", 4))
+    {
+        acc->type = BENCH_ACCESS_ZIPFIAN;
+        acc->theta = arg ? atof(arg + 1) : acc->theta;
+    }
+    else if(!strncmp(spec, "hot", 3))
+    {
+        acc->type = BENCH_ACCESS_HOTSET;
+
+        if(arg && sscanf(arg + 1, "%lf:%lf", &acc->hot_keys, &acc->hot_access) == 2)
+        {
+            acc->hot_keys /= 100;
+            acc->hot_access /= 100;
+        }
+    }
+    else
+        return -1;
+
+    return (acc->theta > 0 && acc->theta < 1 && acc->hot_keys > 0 && acc->hot_keys <= 1 &&
+            acc->hot_access >= 0 && acc->hot_access <= 1) ? 0 : -1;
+}
+
+/* Generates n distinct keys of a key space and n keys that are never in it */
+static inline void bench_gen_int_keys(uint64_t *keys, uint64_t *miss, size_t n, bench_keys_t space, uint64_t param, uint64_t *rng)
+{
+    const uint64_t base = bench_rand(rng) >> 24;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        switch(space)
+        {
+            case BENCH_KEYS_SEQUENTIAL: keys[i] = i + 1; break;
+            case BENCH_KEYS_STRIDED:    keys[i] = base + i * param; break;
+            case BENCH_KEYS_CLUSTERED:
+                /* A new random base (multiple of the run) at the start of each run */
+                keys[i] = (i % param) ? keys[i - 1] + 1 : ((bench_rand(rng) >> 24) * param);
+                break;
+            default:
+                /* The generator never repeats an output */
+                keys[i] = bench_rand(rng);
+        }
+    }
+
+    /* Structured keys stay below 2^61, so misses with the top bit set never collide */
+    for(size_t i = 0; i < n; i++)
+        miss[i] = (space == BENCH_KEYS_RANDOM) ? bench_rand(rng) : (bench_rand(rng) | (1ULL << 63));
+}
+
+/* Fills count request indexes over n keys, following an access pattern */
+static inline void bench_gen_access(size_t *idx, size_t count, size_t n, const bench_access_t *acc, uint64_t *rng)
+{
+    /* Popular ranks map to random keys, not to the first inserted ones */
+    size_t *perm = (size_t *)malloc(n * sizeof(size_t));
+    const size_t hot = (size_t)(acc->hot_keys * n) ? (size_t)(acc->hot_keys * n) : 1;
+    bench_zipf_t zipf = {0, 0, 0, 0, 0};
+
+    for(size_t i = 0; i < n; i++)
+        perm[i] = i;
+
+    bench_shuffle(perm, n, sizeof(size_t), rng);
+
+    if(acc->type == BENCH_ACCESS_ZIPFIAN)
+        bench_zipf_init(&zipf, n, acc->theta);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        switch(acc->type)
+        {
+            case BENCH_ACCESS_UNIFORM: idx[i] = bench_rand(rng) % n; break;
+            case BENCH_ACCESS_ZIPFIAN: idx[i] = perm[bench_zipf_next(&zipf, rng)]; break;
+            case BENCH_ACCESS_HOTSET:
+                if(bench_rand_double(rng) < acc->hot_access || hot == n)
+                    idx[i] = perm[bench_rand(rng) % hot];
+                else
+                    idx[i] = perm[hot + bench_rand(rng) % (n - hot)];
+                break;
+            default:
+                idx[i] = perm[i % n];
+        }
+    }
+
+    free(perm);
+}
+
+/* Fixed width suffix of the string keys - Keeps them unique */
+#define BENCH_STR_SUFFIX  6
+#define BENCH_STR_MAX_LEN (2 + 24 + BENCH_STR_SUFFIX + 1)
+
+/* Random alphanumeric string of 8 to 31 bytes, unique per idx (first overrides the first character if set) */
+static inline void bench_gen_str(char *dst, size_t idx, uint64_t *rng, char first)
+{
+    static const char alnum[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    const size_t prefix = 2 + bench_rand(rng) % 24;
+
+    for(size_t i = 0; i < prefix; i++)
+        dst[i] = alnum[bench_rand(rng) % 62];
+
+    for(size_t i = 0; i < BENCH_STR_SUFFIX; i++, idx /= 62)
+        dst[prefix + i] = alnum[idx % 62];
+
+    dst[0] = first ? first : dst[0];
+    dst[prefix + BENCH_STR_SUFFIX] = '\0';
+}
+
+/* ---- Statistics ---- */
+
+static int _bench_cmp_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Nearest rank percentile of sorted samples (pct in [0, 100]) */
+static inline double bench_percentile(const double *sorted, size_t n, double pct)
+{
+    size_t rank = (size_t)(pct / 100.0 * n + 0.5);
+
+    return sorted[(rank > 0) ? ((rank <= n) ? rank - 1 : n - 1) : 0];
+}
+
+/* Summarizes the per rep samples (total ns and cycles for ops operations) - Sorts them */
+static inline void bench_summarize(bench_result_t *res, double *ns, double *cycles, size_t reps, size_t ops)
+{
+    for(size_t i = 0; i < reps; i++)
+    {
+        ns[i] /= ops;
+        cycles[i] /= ops;
+    }
+
+    qsort(ns, reps, sizeof(double), _bench_cmp_double);
+    qsort(cycles, reps, sizeof(double), _bench_cmp_double);
+
+    res->ops = ops;
+    res->reps = reps;
+    res->min_ns = ns[0];
+    res->median_ns = bench_percentile(ns, reps, 50);
+    res->p90_ns = bench_percentile(ns, reps, 90);
+    res->max_ns = ns[reps - 1];
+    res->cycles = bench_percentile(cycles, reps, 50);
+}
+
+/* ---- Latency histograms ---- */
+
+static inline void bench_hist_reset(bench_hist_t *hist, uint64_t offset)
+{
+    memset(hist, 0, sizeof(bench_hist_t));
+    hist->offset = offset;
+}
+
+static inline size_t bench_hist_index(uint64_t value)
+{
+    if(value < BENCH_HIST_SUB)
+        return value;
+
+    /* Position of the highest bit decides the power of 2, the next bits the sub-bucket */
+    const int shift = 63 - __builtin_clzll(value) - BENCH_HIST_SUB_BITS;
+
+    return ((size_t)(shift + 1) << BENCH_HIST_SUB_BITS) + ((value >> shift) - BENCH_HIST_SUB);
+}
+
+/* Lowest and highest value that fall in a bucket */
+static inline uint64_t bench_hist_low(size_t idx)
+{
+    if(idx < BENCH_HIST_SUB)
+        return idx;
+
+    const int shift = (idx >> BENCH_HIST_SUB_BITS) - 1;
+
+    return (uint64_t)(BENCH_HIST_SUB + (idx & (BENCH_HIST_SUB - 1))) << shift;
+}
+
+static inline uint64_t bench_hist_high(size_t idx)
+{
+    return (idx + 1 < BENCH_HIST_BUCKETS) ? bench_hist_low(idx + 1) - 1 : UINT64_MAX;
+}
+
+static inline void bench_hist_record(bench_hist_t *hist, uint64_t value)
+{
+    value = (value > hist->offset) ? value - hist->offset : 0;
+
+    hist->counts[bench_hist_index(value)]++;
+    hist->total++;
+    hist->max = (value > hist->max) ? value : hist->max;
+}
+
+/* Value at a percentile - Highest value of the bucket, as HDR reports it (exact max at 100) */
+static inline uint64_t bench_hist_value_at(const bench_hist_t *hist, double pct)
+{
+    const uint64_t target = (uint64_t)(pct / 100.0 * hist->total + 0.5);
+    uint64_t seen = 0;
+
+    for(size_t i = 0; i < BENCH_HIST_BUCKETS; i++)
+    {
+        seen += hist->counts[i];
+
+        if(seen >= target && seen)
+            return (bench_hist_high(i) < hist->max) ? bench_hist_high(i) : hist->max;
+    }
+
+    return hist->max;
+}
+
+/* Fills the latency fields of a result (in ns) */
+static inline void bench_hist_summarize(bench_result_t *res, const bench_hist_t *hist, double ticks_per_ns)
+{
+    res->lat_p50 = bench_hist_value_at(hist, 50) / ticks_per_ns;
+    res->lat_p99 = bench_hist_value_at(hist, 99) / ticks_per_ns;
+    res->lat_p999 = bench_hist_value_at(hist, 99.9) / ticks_per_ns;
+    res->lat_max = hist->max / ticks_per_ns;
+}
+
+/* Dumps the non empty buckets as CSV rows (name, low ns, high ns, count, cumulative percentile) */
+static inline void bench_hist_dump(FILE *out, const char *name, const bench_hist_t *hist, double ticks_per_ns)
+{
+    uint64_t seen = 0;
+
+    for(size_t i = 0; i < BENCH_HIST_BUCKETS; i++)
+    {
+        if(!hist->counts[i])
+            continue;
+
+        seen += hist->counts[i];
+        fprintf(out, "%s,%.1f,%.1f,%llu,%.4f\n", name, bench_hist_low(i) / ticks_per_ns, bench_hist_high(i) / ticks_per_ns,
+                (unsigned long long)hist->counts[i], 100.0 * seen / hist->total);
+    }
+}
+
+/* ---- Hardware counters ---- */
+
+/* Opens the counters for the calling thread - Returns how many are available */
+static inline int bench_perf_open(bench_perf_t *perf)
+{
+    int opened = 0;
+
+    for(int i = 0; i < BENCH_PERF_EVENTS; i++)
+        perf->fd[i] = -1;
+
+#ifdef BENCH_HAVE_PERF
+    static const uint32_t types[BENCH_PERF_EVENTS] =
+    {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE
+    };
+    static const uint64_t configs[BENCH_PERF_EVENTS] =
+    {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    for(int i = 0; i < BENCH_PERF_EVENTS; i++)
+    {
+        struct perf_event_attr attr;
+
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[i];
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        perf->fd[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        opened += (perf->fd[i] >= 0);
+    }
+#endif
+
+    return opened;
+}
+
+/* Applies a perf ioctl (reset, enable, disable) to every open counter */
+static inline void _bench_perf_ioctl(bench_perf_t *perf, unsigned long request)
+{
+#ifdef BENCH_HAVE_PERF
+    for(int i = 0; i < BENCH_PERF_EVENTS; i++)
+    {
+        if(perf->fd[i] >= 0)
+            ioctl(perf->fd[i], request, 0);
+    }
+#endif
+}
+
+#ifdef BENCH_HAVE_PERF
+#define bench_perf_reset(perf)   _bench_perf_ioctl(perf, PERF_EVENT_IOC_RESET)
+#define bench_perf_enable(perf)  _bench_perf_ioctl(perf, PERF_EVENT_IOC_ENABLE)
+#define bench_perf_disable(perf) _bench_perf_ioctl(perf, PERF_EVENT_IOC_DISABLE)
+#else
+#define bench_perf_reset(perf)   ((void)(perf))
+#define bench_perf_enable(perf)  ((void)(perf))
+#define bench_perf_disable(perf) ((void)(perf))
+#endif
+
+/* Reads the counters divided by ops - Scaled up if the kernel multiplexed them */
+static inline void bench_perf_read(bench_perf_t *perf, double *values, size_t ops)
+{
+    for(int i = 0; i < BENCH_PERF_EVENTS; i++)
+    {
+        values[i] = -1;
+
+#ifdef BENCH_HAVE_PERF
+        uint64_t data[3];
+
+        if(perf->fd[i] < 0 || read(perf->fd[i], data, sizeof(data)) != sizeof(data) || !data[2])
+            continue;
+
+        values[i] = (double)data[0] * ((double)data[1] / data[2]) / ops;
+#endif
+    }
+}
+
+static inline void bench_perf_close(bench_perf_t *perf)
+{
+#ifdef BENCH_HAVE_PERF
+    for(int i = 0; i < BENCH_PERF_EVENTS; i++)
+    {
+        if(perf->fd[i] >= 0)
+            close(perf->fd[i]);
+    }
+#endif
+}
+
+/* ---- Reporting ---- */
+
+/* Header of a report - Config is printed along, so runs can be compared */
+static inline void bench_report_begin(FILE *out, bench_format_t fmt, uint64_t seed, int cpu, size_t warmup, const char *keys,
+                                      const char *access)
+{
+    if(fmt == BENCH_FORMAT_CSV)
+    {
+        fprintf(out, "scenario,ops,reps,min_ns,median_ns,p90_ns,max_ns,cycles_per_op,lat_p50_ns,lat_p99_ns,lat_p999_ns,lat_max_ns");
+
+        for(int i = 0; i < BENCH_PERF_EVENTS; i++)
+            fprintf(out, ",%s_per_op", bench_perf_names[i]);
+
+        fprintf(out, "\n");
+    }
+    else if(fmt == BENCH_FORMAT_JSON)
+        fprintf(out, "{\"seed\": %llu, \"cpu\": %d, \"warmup\": %zu, \"keys\": \"%s\", \"access\": \"%s\", \"results\": [",
+                (unsigned long long)seed, cpu, warmup, keys, access);
+    else
+        fprintf(out, "seed %llu - cpu %d - warmup %zu - keys %s - access %s\n%-24s %10s %10s %10s %10s %10s | %10s %10s %10s %10s\n",
+                (unsigned long long)seed, cpu, warmup, keys, access, "scenario", "min ns", "median ns", "p90 ns", "max ns", "cycles",
+                "lat p50", "lat p99", "lat p99.9", "lat max");
+}
+
+static inline void bench_report(FILE *out, bench_format_t fmt, const bench_result_t *res, int first)
+{
+    int counted = 0;
+
+    if(fmt == BENCH_FORMAT_CSV)
+    {
+        fprintf(out, "%s,%zu,%zu,%.2f,%.2f,%.2f,%.2f,%.1f,%.1f,%.1f,%.1f,%.1f", res->name, res->ops, res->reps,
+                res->min_ns, res->median_ns, res->p90_ns, res->max_ns, res->cycles,
+                res->lat_p50, res->lat_p99, res->lat_p999, res->lat_max);
+
+        for(int i = 0; i < BENCH_PERF_EVENTS; i++)
+            fprintf(out, ",%.3f", res->perf[i]);
+
+        fprintf(out, "\n");
+    }
+    else if(fmt == BENCH_FORMAT_JSON)
+    {
+        fprintf(out, "%s\n  {\"scenario\": \"%s\", \"ops\": %zu, \"reps\": %zu, \"min_ns\": %.2f, \"median_ns\": %.2f, "
+                "\"p90_ns\": %.2f, \"max_ns\": %.2f, \"cycles_per_op\": %.1f, \"lat_p50_ns\": %.1f, \"lat_p99_ns\": %.1f, "
+                "\"lat_p999_ns\": %.1f, \"lat_max_ns\": %.1f", first ? "" : ",", res->name, res->ops, res->reps,
+                res->min_ns, res->median_ns, res->p90_ns, res->max_ns, res->cycles,
+                res->lat_p50, res->lat_p99, res->lat_p999, res->lat_max);
+
+        for(int i = 0; i < BENCH_PERF_EVENTS; i++)
+            fprintf(out, ", \"%s_per_op\": %.3f", bench_perf_names[i], res->perf[i]);
+
+        fprintf(out, "}");
+    }
+    else
+    {
+        fprintf(out, "%-24s %10.2f %10.2f %10.2f %10.2f %10.1f | %10.1f %10.1f %10.1f %10.1f\n", res->name, res->min_ns,
+                res->median_ns, res->p90_ns, res->max_ns, res->cycles, res->lat_p50, res->lat_p99, res->lat_p999, res->lat_max);
+
+        /* Counters on a line of their own, only if any of them was counted */
+        for(int i = 0; i < BENCH_PERF_EVENTS; i++)
+        {
+            if(res->perf[i] < 0)
+                continue;
+
+            fprintf(out, "%s%s %.3f", counted ? ", " : "    per op: ", bench_perf_names[i], res->perf[i]);
+            counted = 1;
+        }
+
+        if(counted)
+            fprintf(out, "\n");
+    }
+}
+
+static inline void bench_report_end(FILE *out, bench_format_t fmt)
+{
+    if(fmt == BENCH_FORMAT_JSON)
+        fprintf(out, "\n]}\n");
+}
+
+#endif   // __BENCH_UTIL_H //
@@ -0,0 +1,448 @@
+/////////////////////////////////
+// Header comment place holder //
+/////////////////////////////////
+
+/* YCSB style mixed workloads on the flat variant. A fixed number of records is loaded
+ * and kept live, inserts of new records retire the oldest ones (churn), so the table
+ * reaches a steady state with tombstones before anything is measured. */
+
+#include "bench_util.h"
+#include "flat_sparse_hashtable.h"
+#include <unistd.h>
+
+/* Defaults of the command line options */
+#define YCSB_DEF_RECORDS (1 << 20)
+#define YCSB_DEF_KEY_SZ  8
+#define YCSB_DEF_VAL_SZ  32
+#define YCSB_DEF_THETA   0.99
+#define YCSB_DEF_CHURN   1
+#define YCSB_DEF_WINDOWS 10
+#define YCSB_DEF_SEED    0x5eed5eedULL
+
+/* Sizes of test_int.c - Keys {4, 8, 16, 64} and payloads {4, 8, 20, 32, 64, 128}
+ * (Payloads of 4 bytes are left out, records need 8 bytes for their counter) */
+#define YCSB_MAX_KEY_SZ 64
+#define YCSB_MAX_VAL_SZ 128
+
+static const size_t key_sizes[] = {4, 8, 16, 64};
+static const size_t val_sizes[] = {8, 20, 32, 64, 128};
+
+/* Longest multi-get that replaces the scans of workload E */
+#define YCSB_MAX_SCAN 10
+
+/* Operation types - Also the order of the latency histograms */
+typedef enum ycsb_op_enum
+{
+    OP_READ,
+    OP_UPDATE,
+    OP_INSERT,
+    OP_SCAN,
+    OP_RMW,
+    OP_TYPES
+} ycsb_op_t;
+
+static const char *const op_names[OP_TYPES] = {"read", "update", "insert", "scan", "rmw"};
+
+/* Distribution of the requested records */
+typedef enum ycsb_dist_enum
+{
+    DIST_ZIPFIAN,
+    DIST_LATEST
+} ycsb_dist_t;
+
+/* **** ycsb_workload_t ****
+ *
+ * Mix of a workload in percent (the rest of the ops are reads) and the
+ * distribution of the records it requests, as defined by the core YCSB workloads.
+ */
+typedef struct ycsb_workload_struct
+{
+    const char *name;
+    int update;
+    int insert;
+    int scan;
+    int rmw;
+    ycsb_dist_t dist;
+} ycsb_workload_t;
+
+static const ycsb_workload_t workloads[] =
+{
+    {"A", 50, 0,  0,  0,  DIST_ZIPFIAN}, /* Update heavy */
+    {"B", 5,  0,  0,  0,  DIST_ZIPFIAN}, /* Read mostly */
+    {"C", 0,  0,  0,  0,  DIST_ZIPFIAN}, /* Read only */
+    {"D", 0,  5,  0,  0,  DIST_LATEST},  /* Read latest */
+    {"E", 0,  5,  95, 0,  DIST_ZIPFIAN}, /* Short ranges (multi-gets of consecutive records) */
+    {"F", 0,  0,  0,  50, DIST_ZIPFIAN}, /* Read-modify-write */
+};
+
+/* A planned operation - Record id (first one for scans) and scan length */
+typedef struct ycsb_plan_struct
+{
+    uint64_t id;
+    uint8_t op;
+    uint8_t len;
+} ycsb_plan_t;
+
+/* **** ycsb_state_t ****
+ *
+ * Live records are the ids in [oldest, next), always st->records of them.
+ */
+typedef struct ycsb_state_struct
+{
+    size_t records;
+    size_t key_sz;
+    size_t val_sz;
+    int churn;
+    uint64_t seed;
+
+    uint64_t oldest;
+    uint64_t next;
+
+    flat_hashtable_t *table;
+    bench_hist_t *hist[OP_TYPES];
+} ycsb_state_t;
+
+/* ---- Records ---- */
+
+/* Bijective mixers, so distinct ids give distinct keys */
+static inline uint32_t mix32(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    return x ^ (x >> 16);
+}
+
+static inline uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/* Key of a record id - Sparse 32/64-bit identifier, the rest of a wide key stays 0 */
+static inline void make_key(const ycsb_state_t *st, uint64_t id, uint8_t *key)
+{
+    if(st->key_sz == sizeof(uint32_t))
+    {
+        const uint32_t k = mix32((uint32_t)id);
+        memcpy(key, &k, sizeof(k));
+    }
+    else
+    {
+        const uint64_t k = mix64(id);
+        memcpy(key, &k, sizeof(k));
+    }
+}
+
+static int valid_size(size_t size, const size_t *sizes, size_t num)
+{
+    for(size_t i = 0; i < num; i++)
+    {
+        if(sizes[i] == size)
+            return 1;
+    }
+
+    return 0;
+}
+
+/* ---- Planning ---- */
+
+/* Live offset of a request (0 is the oldest record) - Popular ranks are scattered for zipfian */
+static inline uint64_t pick_offset(const ycsb_workload_t *wl, const bench_zipf_t *zipf, uint64_t *rng, uint64_t span)
+{
+    const uint64_t rank = bench_zipf_next(zipf, rng);
+
+    if(wl->dist == DIST_LATEST)
+        return span - 1 - (rank % span);
+
+    return mix64(rank) % span;
+}
+
+/* Plans ops operations ahead, so the generators are not part of the timings */
+static void plan_ops(ycsb_state_t *st, const ycsb_workload_t *wl, const bench_zipf_t *zipf, uint64_t *rng,
+                     ycsb_plan_t *plan, size_t ops)
+{
+    uint64_t oldest = st->oldest, next = st->next;
+
+    for(size_t i = 0; i < ops; i++)
+    {
+        const int dice = bench_rand(rng) % 100;
+        ycsb_plan_t *p = &plan[i];
+
+        p->len = 1;
+
+        /* Churn comes on top of the mix of every workload */
+        if((int)(bench_rand(rng) % 100) < st->churn || dice < wl->insert)
+        {
+            p->op = OP_INSERT;
+            p->id = next++;
+            oldest++;
+            continue;
+        }
+
+        if(dice < wl->insert + wl->scan)
+        {
+            p->op = OP_SCAN;
+            p->len = 1 + bench_rand(rng) % YCSB_MAX_SCAN;
+            p->id = oldest + pick_offset(wl, zipf, rng, st->records - p->len + 1);
+            continue;
+        }
+
+        p->op = (dice < wl->insert + wl->scan + wl->update) ? OP_UPDATE :
+                (dice < wl->insert + wl->scan + wl->update + wl->rmw) ? OP_RMW : OP_READ;
+        p->id = oldest + pick_offset(wl, zipf, rng, st->records);
+    }
+}
+
+/* ---- Execution ---- */
+
+/* Executes an operation - Returns the number of records it missed (0 in a correct run) */
+static inline size_t run_op(ycsb_state_t *st, const ycsb_plan_t *p, uint8_t *key, uint8_t *val)
+{
+    size_t missed = 0;
+    int err;
+
+    switch(p->op)
+    {
+        case OP_READ:
+            make_key(st, p->id, key);
+            missed = !ht_flat_search(st->table, key);
+            break;
+
+        case OP_UPDATE:
+            make_key(st, p->id, key);
+            memcpy(val, &p->id, sizeof(p->id));
+            missed = ht_flat_emplace(st->table, key, val) != 0;
+            break;
+
+        case OP_INSERT:
+            /* New record in, oldest record out - The working set stays the same */
+            make_key(st, p->id, key);
+            memcpy(val, &p->id, sizeof(p->id));
+            missed = ht_flat_insert(st->table, key, val, &err) || err;
+            make_key(st, st->oldest++, key);
+            missed += ht_flat_delete(st->table, key) != 0;
+            st->next++;
+            break;
+
+        case OP_SCAN:
+            for(uint64_t id = p->id; id < p->id + p->len; id++)
+            {
+                make_key(st, id, key);
+                missed += !ht_flat_search(st->table, key);
+            }
+            break;
+
+        case OP_RMW:
+        {
+            make_key(st, p->id, key);
+            uint8_t *rec = ht_flat_search(st->table, key);
+            uint64_t counter;
+
+            /* Entries are not aligned in the table */
+            if(rec)
+            {
+                memcpy(&counter, rec, sizeof(counter));
+                counter++;
+                memcpy(rec, &counter, sizeof(counter));
+            }
+            else
+                missed = 1;
+            break;
+        }
+    }
+
+    return missed;
+}
+
+/* Runs the planned operations - Times each one if the latencies are recorded */
+static size_t run_plan(ycsb_state_t *st, const ycsb_plan_t *plan, size_t ops, uint8_t *key, uint8_t *val)
+{
+    size_t missed = 0;
+
+    for(size_t i = 0; i < ops; i++)
+    {
+        if(st->hist[0])
+        {
+            const uint64_t start = bench_cycles();
+            missed += run_op(st, &plan[i], key, val);
+            bench_hist_record(st->hist[plan[i].op], bench_cycles() - start);
+        }
+        else
+            missed += run_op(st, &plan[i], key, val);
+    }
+
+    return missed;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-y workloads (i.e ACF, default all)] [-n records] [-o ops (default 4 * records)] "
+            "[-W warmup ops (default records)] [-k key size (4|8|16|64)] [-v value size (8|20|32|64|128)] "
+            "[-z zipfian theta] [-u churn percent] [-m measurement windows] [-c cpu] [-s seed] [-f text|csv] [-l (latencies)]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    ycsb_state_t st = {.records = YCSB_DEF_RECORDS, .key_sz = YCSB_DEF_KEY_SZ, .val_sz = YCSB_DEF_VAL_SZ,
+                       .churn = YCSB_DEF_CHURN, .seed = YCSB_DEF_SEED};
+    const char *selected = "ABCDEF";
+    size_t ops = 0, warmup_ops = 0, windows = YCSB_DEF_WINDOWS;
+    double theta = YCSB_DEF_THETA;
+    bench_format_t fmt = BENCH_FORMAT_TEXT;
+    int cpu = 0, opt, latency = 0;
+
+    while((opt = getopt(argc, argv, "y:n:o:W:k:v:z:u:m:c:s:f:lh")) != -1)
+    {
+        switch(opt)
+        {
+            case 'y': selected = optarg; break;
+            case 'n': st.records = strtoull(optarg, NULL, 0); break;
+            case 'o': ops = strtoull(optarg, NULL, 0); break;
+            case 'W': warmup_ops = strtoull(optarg, NULL, 0); break;
+            case 'k': st.key_sz = strtoull(optarg, NULL, 0); break;
+            case 'v': st.val_sz = strtoull(optarg, NULL, 0); break;
+            case 'z': theta = atof(optarg); break;
+            case 'u': st.churn = atoi(optarg); break;
+            case 'm': windows = strtoull(optarg, NULL, 0); break;
+            case 'c': cpu = atoi(optarg); break;
+            case 's': st.seed = strtoull(optarg, NULL, 0); break;
+            case 'l': latency = 1; break;
+            case 'f': fmt = !strcmp(optarg, "csv") ? BENCH_FORMAT_CSV : BENCH_FORMAT_TEXT; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    ops = ops ? ops : 4 * st.records;
+    warmup_ops = warmup_ops ? warmup_ops : st.records;
+
+    /* Sizes of the test_int.c enums only */
+    if(st.records < 2 * YCSB_MAX_SCAN || !windows || windows > ops || theta <= 0 || theta >= 1 || st.churn < 0 ||
+       st.churn > 100 || !valid_size(st.key_sz, key_sizes, 4) || !valid_size(st.val_sz, val_sizes, 5))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if(bench_pin_cpu(cpu))
+    {
+        fprintf(stderr, "Could not pin to cpu %d - Running unpinned\n", cpu);
+        cpu = -1;
+    }
+
+    uint8_t key[YCSB_MAX_KEY_SZ] = {0}, val[YCSB_MAX_VAL_SZ] = {0};
+    ycsb_plan_t *plan = malloc((warmup_ops + ops) * sizeof(ycsb_plan_t));
+    double *mops = malloc(windows * sizeof(double));
+    const double ticks_per_ns = latency ? bench_ticks_per_ns() : 1.0;
+    const uint64_t overhead = latency ? bench_timer_overhead() : 0;
+    bench_zipf_t zipf;
+
+    bench_zipf_init(&zipf, st.records, theta);
+
+    if(latency)
+    {
+        for(int i = 0; i < OP_TYPES; i++)
+            st.hist[i] = malloc(sizeof(bench_hist_t));
+    }
+
+    if(fmt == BENCH_FORMAT_CSV)
+        printf("workload,op,key_sz,val_sz,records,ops,capacity,median_mops,min_mops,max_mops,lat_p50_ns,lat_p99_ns,lat_p999_ns,lat_max_ns\n");
+    else
+        printf("seed %llu - cpu %d - %zu records - %zu ops - key %zu - value %zu - theta %.2f - churn %d%%\n"
+               "%-8s %-6s %10s %12s %12s %12s | %10s %10s %10s %10s\n", (unsigned long long)st.seed, cpu, st.records, ops,
+               st.key_sz, st.val_sz, theta, st.churn, "workload", "op", "capacity", "median Mops", "min Mops", "max Mops",
+               "lat p50", "lat p99", "lat p99.9", "lat max");
+
+    for(size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++)
+    {
+        const ycsb_workload_t *wl = &workloads[w];
+        uint64_t rng = st.seed;
+        int err;
+
+        if(!strchr(selected, wl->name[0]))
+            continue;
+
+        /* Load phase - Every workload starts from the same records */
+        st.table = ht_flat_create(st.records, st.val_sz, st.key_sz, &err);
+        ht_flat_reseed(st.table, st.seed);
+        st.oldest = 0;
+        st.next = st.records;
+
+        for(uint64_t id = 0; id < st.records; id++)
+        {
+            make_key(&st, id, key);
+            ht_flat_insert(st.table, key, val, &err);
+        }
+
+        /* Warmup until the churn has settled the tombstones and the capacity */
+        plan_ops(&st, wl, &zipf, &rng, plan, warmup_ops + ops);
+
+        size_t missed = run_plan(&st, plan, warmup_ops, key, val);
+
+        for(int i = 0; latency && i < OP_TYPES; i++)
+            bench_hist_reset(st.hist[i], overhead);
+
+        /* Measured phase - Split in windows, their spread shows if it is really steady */
+        for(size_t i = 0; i < windows; i++)
+        {
+            const size_t start = warmup_ops + i * ops / windows, end = warmup_ops + (i + 1) * ops / windows;
+            const uint64_t t_start = bench_now_ns();
+
+            missed += run_plan(&st, &plan[start], end - start, key, val);
+            mops[i] = (double)(end - start) * 1000.0 / (bench_now_ns() - t_start);
+        }
+
+        /* Every request targets a live record */
+        if(missed)
+        {
+            fprintf(stderr, "Workload %s: %zu requests missed their record | Exiting...\n", wl->name, missed);
+            exit(1);
+        }
+
+        qsort(mops, windows, sizeof(double), _bench_cmp_double);
+
+        const double med = bench_percentile(mops, windows, 50);
+        const size_t capacity = ht_flat_get_capacity(st.table);
+
+        if(fmt == BENCH_FORMAT_CSV)
+            printf("%s,all,%zu,%zu,%zu,%zu,%zu,%.3f,%.3f,%.3f,0,0,0,0\n", wl->name, st.key_sz, st.val_sz, st.records, ops,
+                   capacity, med, mops[0], mops[windows - 1]);
+        else
+            printf("%-8s %-6s %10zu %12.3f %12.3f %12.3f |\n", wl->name, "all", capacity, med, mops[0], mops[windows - 1]);
+
+        /* Latencies per operation type of the measured phase */
+        for(int i = 0; latency && i < OP_TYPES; i++)
+        {
+            bench_result_t res;
+
+            if(!st.hist[i]->total)
+                continue;
+
+            bench_hist_summarize(&res, st.hist[i], ticks_per_ns);
+
+            if(fmt == BENCH_FORMAT_CSV)
+                printf("%s,%s,%zu,%zu,%zu,%llu,%zu,0,0,0,%.1f,%.1f,%.1f,%.1f\n", wl->name, op_names[i], st.key_sz, st.val_sz,
+                       st.records, (unsigned long long)st.hist[i]->total, capacity, res.lat_p50, res.lat_p99,
+                       res.lat_p999, res.lat_max);
+            else
+                printf("%-8s %-6s %10s %12s %12s %12s | %10.1f %10.1f %10.1f %10.1f\n", "", op_names[i], "", "", "", "",
+                       res.lat_p50, res.lat_p99, res.lat_p999, res.lat_max);
+        }
+
+        ht_flat_free(st.table);
+    }
+
+    for(int i = 0; latency && i < OP_TYPES; i++)
+        free(st.hist[i]);
+
+    free(plan);
+    free(mops);
+
+    return 0;
+}
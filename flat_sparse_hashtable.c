@@ -78,14 +78,26 @@ struct flat_hashtable_struct
     /* The bitmap used for metadata of the keys */
     uint8_t *bitmap;
 
-    /* Total entries in the map */
+    /* Total entries and tombstones in the map */
     size_t entries;
+    size_t deleted;
 
     /* Used for hashing - Randomizes hash for each run */
     size_t hash_seed;
 
+    /* Bounded cache only - Maximum entries (0 when unbounded), the CLOCK hand
+     * over the groups and the reference bits (one 16-bit mask per group) */
+    size_t max_entries;
+    size_t clock_hand;
+    uint16_t *ref_bits;
+
     /* Iterator sub-structure */
     hashtable_iter_t iterator;
+
+#ifdef HT_STATS
+    /* Operation counters */
+    ht_op_stats_t stats;
+#endif
 };
 
 /**************************** Private function Prototypes ******************************/
@@ -93,14 +105,24 @@ struct flat_hashtable_struct
 /* Utility sub-routines */
 static int _ht_comp_key(const void *key1, const void *key2, const size_t key_sz);
 static void _ht_copy_key(const void *key1, const void *key2, const size_t key_sz);
-static inline size_t _ht_flat_hasher(const char *key, size_t hash_sz);
+static inline size_t _ht_flat_hasher(const char *key, size_t hash_sz, uint64_t seed);
 
 /* Sub-routines for the main operations of the hashtable */
-static void *_ht_flat_search(flat_hashtable_t *hashtable, const void *key);
-static void *_ht_flat_insert(flat_hashtable_t *hashtable, const void *key, const void *entry, char flag);
-static int _ht_flat_delete(flat_hashtable_t *hashtable, const void *key);
+static flat_hashtable_t *_ht_flat_create(size_t hashtable_sz, size_t entry_sz, size_t key_sz, int *error_code);
+static inline size_t _ht_flat_find(flat_hashtable_t *hashtable, const void *key, size_t hash);
+static inline size_t _ht_flat_find_free(flat_hashtable_t *hashtable, size_t hash);
+static inline size_t _ht_flat_find_or_free(flat_hashtable_t *hashtable, const void *key, size_t hash, int *found);
+static inline void *_ht_flat_place(flat_hashtable_t *hashtable, size_t idx, size_t hash, const void *key);
+static inline void _ht_flat_erase_slot(flat_hashtable_t *hashtable, size_t idx);
+static void *_ht_flat_search(flat_hashtable_t *hashtable, const void *key, size_t hash);
+static void *_ht_flat_insert(flat_hashtable_t *hashtable, const void *key, const void *entry, size_t hash, char flag);
+static void *_ht_flat_find_or_insert(flat_hashtable_t *hashtable, const void *key, size_t hash, int *inserted, int *error_code);
+static int _ht_flat_delete(flat_hashtable_t *hashtable, const void *key, size_t hash);
 static int _ht_flat_resize(flat_hashtable_t *hashtable, size_t new_sz);
 
+/* Bounded cache sub-routine */
+static void _ht_flat_cache_evict(flat_hashtable_t *hashtable);
+
 /* Iterator sub-routine */
 static int _ht_iter_valid_group(flat_hashtable_t *hashtable, size_t *start_group, uint16_t *final_group_mask, short int direction);
 
@@ -145,22 +167,22 @@ static void _ht_copy_key(const void *tar, const void *x, const size_t key_sz)
 }
 
 /* Hasher wrapper used for the hashing of the keys */
-static inline size_t _ht_flat_hasher(const char *key, size_t hash_sz)
+static inline size_t _ht_flat_hasher(const char *key, size_t hash_sz, uint64_t seed)
 {
-/* Choose the a function based on specific key_size overide */
+/* Choose the a function based on specific key_size overide - Seeded per table */
 #if defined(HASHER_4BYTE) || defined(HT_FLAT_UINT32_KEY)
-    return hash_32simp(*((uint32_t *)key));
+    return hash_32simp_seeded(*((uint32_t *)key), seed);
 #elif defined(HASHER_8BYTE) || defined(HT_FLAT_UINT64_KEY)
-    return fmix64(*((uint64_t *)key));
+    return fmix64_seeded(*((uint64_t *)key), seed);
 #else
     switch(hash_sz)
     {
     case 4:
-        return hash_32simp(*((uint32_t *)key));
+        return hash_32simp_seeded(*((uint32_t *)key), seed);
     case 8:
-        return fmix64(*((uint64_t *)key));
+        return fmix64_seeded(*((uint64_t *)key), seed);
     default:
-        return hash_MurmurOAAT64(key, hash_sz); /* Default hasher - Good for large payloads */
+        return hash_wyhash(key, hash_sz, seed); /* Default hasher - Good for large payloads */
     }
 #endif
 }
@@ -187,8 +209,8 @@ static int _ht_iter_valid_group(flat_hashtable_t *hashtable, size_t *start_group
     return ITER_NOT_VALID;
 }
 
-/* The main lookup sub-routine */
-static void *_ht_flat_search(flat_hashtable_t *hashtable, const void *key)
+/* The main lookup sub-routine - Returns the slot index of the key or SLOT_NOT_FOUND */
+static inline size_t _ht_flat_find(flat_hashtable_t *hashtable, const void *key, size_t hash)
 {
     /* Constants */
     const size_t step = hashtable->step;
@@ -196,7 +218,6 @@ static void *_ht_flat_search(flat_hashtable_t *hashtable, const void *key)
     const char *table = hashtable->table;
 
     /* Metadata for the given key */
-    const size_t hash = _ht_flat_hasher(key, hashtable->key_sz);
     const uint8_t bitmap_ctrl = hash & GROUP_H2_MASK;
 
     /* Starting group index */
@@ -205,8 +226,12 @@ static void *_ht_flat_search(flat_hashtable_t *hashtable, const void *key)
     size_t probe_step = 1;
 #endif
 
+    HT_STAT_INC(hashtable, searches);
+
     while(1)
     {
+        HT_STAT_INC(hashtable, groups_probed);
+
         /* Create an index for the matches */
         size_t i = group_idx * GROUP_SIZE;
 
@@ -222,7 +247,10 @@ static void *_ht_flat_search(flat_hashtable_t *hashtable, const void *key)
 
             /* Found an empty position */
             if(HT_LIKELY(COMP_KEY_CB(&table[(i + pos) * step], key, hashtable->key_sz)))
-                return (void *)&table[(i + pos) * step + hashtable->key_sz];
+            {
+                HT_STAT_INC(hashtable, hits);
+                return i + pos;
+            }
 
             /* Unset this entry */
             eq_mask ^= 1 << pos;
@@ -230,7 +258,10 @@ static void *_ht_flat_search(flat_hashtable_t *hashtable, const void *key)
 
         /* Search stop condition */
         if(HT_LIKELY(empty_mask))
-            return NULL;
+        {
+            HT_STAT_INC(hashtable, misses);
+            return SLOT_NOT_FOUND;
+        }
 
 /* Probe */
 #ifdef SPARSE_LIN_PROBE
@@ -241,53 +272,97 @@ static void *_ht_flat_search(flat_hashtable_t *hashtable, const void *key)
 #endif
     }
 
-    return NULL; /* Suppress compiler warnings */
+    return SLOT_NOT_FOUND; /* Suppress compiler warnings */
 }
 
-/* The main insertion sub-routine. Performs different kinds of insertion based on action */
-static void *_ht_flat_insert(flat_hashtable_t *hashtable, const void *key, const void *entry, char flag)
+/* Finds the first empty or deleted slot for the given hash */
+static inline size_t _ht_flat_find_free(flat_hashtable_t *hashtable, size_t hash)
 {
-    /* Resizing = NO_SEARCH | Insert = SEARCH_NO_REPLACE */
-    if(flag != NO_SEARCH)
+    const size_t group_mask = hashtable->group_num - 1; /* Now this is a bitmask */
+    size_t group_idx = (hash >> GROUP_H1_SHIFT) & group_mask;
+#ifndef SPARSE_LIN_PROBE
+    size_t probe_step = 1;
+#endif
+
+    while(1)
     {
-        void *ret = _ht_flat_search(hashtable, key);
-        if(ret)
-            return ret;
+        /* Create the new mask */
+        size_t i = group_idx * GROUP_SIZE;
+        uint16_t empty_or_del_mask = _ht_and_mask(&hashtable->bitmap[i], HIGH_BIT_MASK);
+
+        /* Found empty spot */
+        if(empty_or_del_mask)
+            return i + _get_first_set_bit_pos(empty_or_del_mask);
+
+/* Probe */
+#ifdef SPARSE_LIN_PROBE
+        group_idx = (group_idx + 1) & group_mask;
+#else
+        group_idx = (group_idx + probe_step) & group_mask;
+        probe_step++;
+#endif
     }
 
-    /* Restart the search - Constants */
+    return SLOT_NOT_FOUND; /* Suppress compiler warnings */
+}
+
+/* Single probe lookup - Returns the slot of the key or (if it does not exist) the first free slot seen */
+static inline size_t _ht_flat_find_or_free(flat_hashtable_t *hashtable, const void *key, size_t hash, int *found)
+{
+    /* Constants */
     const size_t step = hashtable->step;
-    const size_t group_mask = hashtable->group_num - 1; /* Now this is a bitmask */
-    const size_t hash = _ht_flat_hasher(key, hashtable->key_sz);
+    const size_t group_mask = hashtable->group_num - 1; /* Now this becomes a mask */
+    const char *table = hashtable->table;
+    const uint8_t bitmap_ctrl = hash & GROUP_H2_MASK;
 
-    /* Initial conditions */
-    char *table = hashtable->table;
+    /* Starting group index */
     size_t group_idx = (hash >> GROUP_H1_SHIFT) & group_mask;
+    size_t free_idx = SLOT_NOT_FOUND;
 #ifndef SPARSE_LIN_PROBE
     size_t probe_step = 1;
 #endif
 
     while(1)
     {
-        /* Create the new mask */
         size_t i = group_idx * GROUP_SIZE;
+
+        HT_STAT_INC(hashtable, groups_probed);
+
+        /* Create the masks */
         uint8_t *bitmap_pos = &hashtable->bitmap[i];
-        uint16_t empty_or_del_mask = _ht_and_mask(bitmap_pos, HIGH_BIT_MASK);
+        uint16_t eq_mask = _ht_eq_mask(bitmap_pos, bitmap_ctrl);
+        uint16_t empty_mask = _ht_eq_mask(bitmap_pos, ENTRY_EMPTY);
 
-        /* Found empty spot */
-        if(empty_or_del_mask)
+        /* Find matches */
+        while(eq_mask)
         {
-            size_t pos = _get_first_set_bit_pos(empty_or_del_mask);
+            size_t pos = _get_first_set_bit_pos(eq_mask);
 
-            /* Insertion in the hashtable */
-            COPY_KEY_CB(&table[(i + pos) * step], key, hashtable->key_sz);
-            memcpy(&table[(i + pos) * step + hashtable->key_sz], entry, hashtable->entry_sz);
+            if(HT_LIKELY(COMP_KEY_CB(&table[(i + pos) * step], key, hashtable->key_sz)))
+            {
+                HT_STAT_INC(hashtable, duplicates);
+                *found = 1;
+                return i + pos;
+            }
 
-            /* Fix the bitmap */
-            hashtable->bitmap[i + pos] = hash & (GROUP_H2_MASK);
-            hashtable->entries++;
+            /* Unset this entry */
+            eq_mask ^= 1 << pos;
+        }
 
-            return NULL;
+        /* Remember the first empty or deleted slot of the sequence */
+        if(free_idx == SLOT_NOT_FOUND)
+        {
+            uint16_t empty_or_del_mask = _ht_and_mask(bitmap_pos, HIGH_BIT_MASK);
+
+            if(empty_or_del_mask)
+                free_idx = i + _get_first_set_bit_pos(empty_or_del_mask);
+        }
+
+        /* Search stop condition - There is always a free slot by now */
+        if(HT_LIKELY(empty_mask))
+        {
+            *found = 0;
+            return free_idx;
         }
 
 /* Probe */
@@ -299,16 +374,113 @@ static void *_ht_flat_insert(flat_hashtable_t *hashtable, const void *key, const
 #endif
     }
 
-    return NULL; /* Suppress compiler warnings */
+    return SLOT_NOT_FOUND; /* Suppress compiler warnings */
+}
+
+/* Stores the key in a free slot, updates the metadata and returns the entry of the slot */
+static inline void *_ht_flat_place(flat_hashtable_t *hashtable, size_t idx, size_t hash, const void *key)
+{
+    char *slot = &hashtable->table[idx * hashtable->step];
+
+    /* Insertion in the hashtable */
+    COPY_KEY_CB(slot, key, hashtable->key_sz);
+
+    /* Fix the bitmap - Tombstones are reused */
+    hashtable->deleted -= (hashtable->bitmap[idx] == ENTRY_DELETED);
+    hashtable->bitmap[idx] = hash & (GROUP_H2_MASK);
+    hashtable->entries++;
+
+    return slot + hashtable->key_sz;
+}
+
+/* Removes the entry of a known slot */
+static inline void _ht_flat_erase_slot(flat_hashtable_t *hashtable, size_t idx)
+{
+    uint8_t *bitmap_pos = &hashtable->bitmap[idx & ~((size_t)GROUP_SIZE - 1)];
+
+    /* Put a tombstone only if there are no empty entries in the group */
+    if(_ht_eq_mask(bitmap_pos, ENTRY_EMPTY))
+    {
+        hashtable->bitmap[idx] = ENTRY_EMPTY;
+    }
+    else
+    {
+        hashtable->bitmap[idx] = ENTRY_DELETED;
+        hashtable->deleted++;
+    }
+
+    hashtable->entries--;
+    HT_STAT_INC(hashtable, deletes);
+}
+
+/* The main lookup sub-routine */
+static void *_ht_flat_search(flat_hashtable_t *hashtable, const void *key, size_t hash)
+{
+    const size_t idx = _ht_flat_find(hashtable, key, hash);
+
+    if(idx == SLOT_NOT_FOUND)
+        return NULL;
+
+    return (void *)&hashtable->table[idx * hashtable->step + hashtable->key_sz];
+}
+
+/* The main insertion sub-routine. Performs different kinds of insertion based on action */
+static void *_ht_flat_insert(flat_hashtable_t *hashtable, const void *key, const void *entry, size_t hash, char flag)
+{
+    /* Multimap = NO_SEARCH | Insert = SEARCH_NO_REPLACE */
+    if(flag != NO_SEARCH)
+    {
+        void *ret = _ht_flat_search(hashtable, key, hash);
+        if(ret)
+            return ret;
+    }
+
+    /* Restart the search from the same hash */
+    memcpy(_ht_flat_place(hashtable, _ht_flat_find_free(hashtable, hash), hash, key), entry, hashtable->entry_sz);
+
+    return NULL;
+}
+
+/* Single pass insertion sub-routine. Returns the entry of the key (existing or new) */
+static void *_ht_flat_find_or_insert(flat_hashtable_t *hashtable, const void *key, size_t hash, int *inserted, int *error_code)
+{
+    int found;
+    size_t idx = _ht_flat_find_or_free(hashtable, key, hash, &found);
+
+    /* Key exists */
+    if(found)
+    {
+        *inserted = 0;
+        return &hashtable->table[idx * hashtable->step + hashtable->key_sz];
+    }
+
+    /* Grow before placing, so the returned entry stays valid - Resize by doubling */
+    if(hashtable->entries >= UPPER_LIMIT(hashtable->hashtable_sz))
+    {
+        *error_code = _ht_flat_resize(hashtable, hashtable->hashtable_sz << 1);
+
+        if(*error_code != HASH_OK)
+        {
+            *inserted = 0;
+            return NULL;
+        }
+
+        idx = _ht_flat_find_free(hashtable, hash);
+    }
+
+    /* Counted once placed - A failed grow is not an insert */
+    HT_STAT_INC(hashtable, inserts);
+    *inserted = 1;
+
+    return _ht_flat_place(hashtable, idx, hash, key);
 }
 
 /* The main delete sub-routine */
-static int _ht_flat_delete(flat_hashtable_t *hashtable, const void *key)
+static int _ht_flat_delete(flat_hashtable_t *hashtable, const void *key, size_t hash)
 {
     /* Constants */
     const size_t step = hashtable->step;
     const size_t group_mask = hashtable->group_num - 1; /* Now this becomes a mask */
-    const size_t hash = _ht_flat_hasher(key, hashtable->key_sz);
     const uint8_t bitmap_ctrl = hash & GROUP_H2_MASK;
 
     /* Starting group index */
@@ -323,6 +495,8 @@ static int _ht_flat_delete(flat_hashtable_t *hashtable, const void *key)
         /* Index for the <key, entries> table */
         size_t i = group_idx * GROUP_SIZE;
 
+        HT_STAT_INC(hashtable, groups_probed);
+
         /* Create the new masks */
         uint8_t *bitmap_pos = &hashtable->bitmap[i];
         uint16_t eq_mask = _ht_eq_mask(bitmap_pos, bitmap_ctrl);
@@ -337,7 +511,9 @@ static int _ht_flat_delete(flat_hashtable_t *hashtable, const void *key)
             {
                 /* Put a tombstone only if there are no empty entries in the group */
                 hashtable->bitmap[i + pos] = (empty_mask) ? ENTRY_EMPTY : ENTRY_DELETED;
+                hashtable->deleted += !empty_mask;
                 hashtable->entries--;
+                HT_STAT_INC(hashtable, deletes);
 
                 return HASH_OK;
             }
@@ -366,24 +542,35 @@ static int _ht_flat_resize(flat_hashtable_t *hashtable, size_t new_sz)
     /* Constants */
     const size_t key_sz = hashtable->key_sz, step = hashtable->step;
     const size_t num_of_groups = hashtable->hashtable_sz >> GROUP_SIZE_SHIFT;
+#ifdef HT_STATS
+    const uint64_t start_ns = _ht_stat_now_ns();
+#endif
 
     /* New tables */
     char *new_table = malloc((new_sz * step) * sizeof(char));
     uint8_t *new_bitmap = aligned_alloc(BITMAP_FORCE_ALLIGN, new_sz * sizeof(uint8_t));
+    uint16_t *new_ref_bits = hashtable->ref_bits ? calloc(new_sz >> GROUP_SIZE_SHIFT, sizeof(uint16_t)) : NULL;
 
-    if(!new_table || !new_bitmap)
+    if(!new_table || !new_bitmap || (hashtable->ref_bits && !new_ref_bits))
     {
         free(new_table);
         free(new_bitmap);
+        free(new_ref_bits);
         return HASH_REHASH_MEM_ALLOC;
     }
 
     /* Set every entry as empty in the new bitmap */
     memset(new_bitmap, ENTRY_EMPTY, new_sz * sizeof(uint8_t));
 
+    /* Same capacity rehashes only clear the tombstones or apply a new seed */
+    HT_STAT_ADD(hashtable, resizes_up, new_sz > hashtable->hashtable_sz);
+    HT_STAT_ADD(hashtable, resizes_down, new_sz < hashtable->hashtable_sz);
+    HT_STAT_ADD(hashtable, rehashes, new_sz == hashtable->hashtable_sz);
+
     /* Setup variables - Old table parameters */
     char *old_table = hashtable->table;
     uint8_t *old_bitmap = hashtable->bitmap;
+    uint16_t *old_ref_bits = hashtable->ref_bits;
 
     /* Update the new_table parameters */
     hashtable->bitmap = new_bitmap;
@@ -391,6 +578,9 @@ static int _ht_flat_resize(flat_hashtable_t *hashtable, size_t new_sz)
     hashtable->hashtable_sz = new_sz;
     hashtable->group_num = new_sz >> GROUP_SIZE_SHIFT;
     hashtable->entries = 0;
+    hashtable->deleted = 0;
+    hashtable->ref_bits = new_ref_bits;
+    hashtable->clock_hand &= hashtable->group_num - 1;
 
     /* Iterate over the old table */
     for(size_t i = 0; i < num_of_groups; i++)
@@ -410,7 +600,14 @@ static int _ht_flat_resize(flat_hashtable_t *hashtable, size_t new_sz)
             size_t tmp = cur_idx + pos * step;
 
             /* Insert safely - Each key is unique */
-            _ht_flat_insert(hashtable, &old_table[tmp], &old_table[tmp + key_sz], NO_SEARCH);
+            const size_t hash = _ht_flat_hasher(&old_table[tmp], key_sz, hashtable->hash_seed);
+            const size_t new_idx = _ht_flat_find_free(hashtable, hash);
+
+            memcpy(_ht_flat_place(hashtable, new_idx, hash, &old_table[tmp]), &old_table[tmp + key_sz], hashtable->entry_sz);
+
+            /* Bounded caches - The reference bit follows its entry, so the CLOCK state survives */
+            if(old_ref_bits && (old_ref_bits[i] & (1 << pos)))
+                new_ref_bits[new_idx >> GROUP_SIZE_SHIFT] |= 1 << (new_idx & (GROUP_SIZE - 1));
 
             /* Unset this entry */
             valid_entries_mask ^= 1 << pos;
@@ -419,27 +616,51 @@ static int _ht_flat_resize(flat_hashtable_t *hashtable, size_t new_sz)
 
     /* Re-initialise iterator */
     hashtable->iterator.iter_state = ITER_NOT_VALID;
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
 
     /* Free the old tables */
     free(old_bitmap);
     free(old_table);
+    free(old_ref_bits);
+
+    HT_STAT_ADD(hashtable, moved, hashtable->entries);
+    HT_STAT_ADD(hashtable, rehash_ns, _ht_stat_now_ns() - start_ns);
 
     return HASH_OK;
 }
 
-/************************************ Main Routines for Flat ************************************/
-
-flat_hashtable_t *ht_flat_create(size_t hashtable_sz, size_t entry_sz, size_t key_sz, int *error_code)
+/* Evicts one entry of a bounded cache, using the CLOCK policy over the groups */
+static void _ht_flat_cache_evict(flat_hashtable_t *hashtable)
 {
-    /* Set the error code */
-    *error_code = HASH_OK;
+    const size_t group_mask = hashtable->group_num - 1;
+    size_t group_idx = hashtable->clock_hand;
 
-    /* Check input by the user - Necessary inputs */
-    if(!hashtable_sz || !entry_sz || !key_sz)
+    /* After one full sweep every reference bit is cleared, so this terminates */
+    while(1)
     {
-        *error_code = HASH_WRONG_ARGUMENT;
-        return NULL;
+        uint8_t *bitmap_pos = &hashtable->bitmap[group_idx * GROUP_SIZE];
+        uint16_t valid_entries_mask = ~(_ht_and_mask(bitmap_pos, HIGH_BIT_MASK));
+        uint16_t victims_mask = valid_entries_mask & ~hashtable->ref_bits[group_idx];
+
+        /* Entries not referenced since the last sweep are evicted - The hand stays on the group */
+        if(victims_mask)
+        {
+            _ht_flat_erase_slot(hashtable, group_idx * GROUP_SIZE + _get_first_set_bit_pos(victims_mask));
+            hashtable->clock_hand = group_idx;
+            return;
+        }
+
+        /* Second chance for the whole group */
+        hashtable->ref_bits[group_idx] = 0;
+        group_idx = (group_idx + 1) & group_mask;
     }
+}
+
+/* The main constructor sub-routine. Entry size of 0 is allowed here (sets) */
+static flat_hashtable_t *_ht_flat_create(size_t hashtable_sz, size_t entry_sz, size_t key_sz, int *error_code)
+{
+    /* Set the error code */
+    *error_code = HASH_OK;
 
     /* Fix the size for the hashtable
      * Minimum is 32 entries (2 groups) since alligned alloc requires multiples of
@@ -484,30 +705,56 @@ flat_hashtable_t *ht_flat_create(size_t hashtable_sz, size_t entry_sz, size_t ke
     hashtable->key_sz = key_sz;
     hashtable->step = bucket_sz;
     hashtable->entries = 0;
+    hashtable->deleted = 0;
+
+    /* Unbounded by default */
+    hashtable->max_entries = 0;
+    hashtable->clock_hand = 0;
+    hashtable->ref_bits = NULL;
 
-    /* Seeding of the hashtable */
-    //  srand(time(NULL));
-    //  hashtable->hash_seed = rand();
+#ifdef HT_STATS
+    memset(&hashtable->stats, 0, sizeof(ht_op_stats_t));
+#endif
+
+    /* Seeding of the hashtable - Different for every table */
+    hashtable->hash_seed = _ht_generate_seed(hashtable);
 
     /* Initialize iterator */
     hashtable->iterator.iter_state = ITER_NOT_VALID;
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
 
     return hashtable;
 }
 
+/************************************ Main Routines for Flat ************************************/
+
+flat_hashtable_t *ht_flat_create(size_t hashtable_sz, size_t entry_sz, size_t key_sz, int *error_code)
+{
+    /* Check input by the user - Necessary inputs */
+    if(!hashtable_sz || !entry_sz || !key_sz)
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
+    }
+
+    /* The size is a hint of the expected entries - No resize happens until they are inserted */
+    return _ht_flat_create(_get_capacity_for_entries(hashtable_sz), entry_sz, key_sz, error_code);
+}
+
+
 void *ht_flat_search(flat_hashtable_t *hashtable, const void *key)
 {
     /* Check user input */
     if(HT_UNLIKELY(!key || !hashtable))
         return NULL;
 
-    return _ht_flat_search(hashtable, key);
+    return _ht_flat_search(hashtable, key, _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed));
 }
 
 void *ht_flat_insert(flat_hashtable_t *hashtable, const void *key, const void *entry, int *error_code)
 {
-    /* Check user input */
-    if(HT_UNLIKELY(!key || !entry || !hashtable || !error_code))
+    /* Check user input - Bounded caches insert only through put() */
+    if(HT_UNLIKELY(!key || !entry || !hashtable || !error_code || hashtable->max_entries))
     {
         *error_code = HASH_WRONG_ARGUMENT;
         return NULL;
@@ -516,13 +763,14 @@ void *ht_flat_insert(flat_hashtable_t *hashtable, const void *key, const void *e
     /* Set error code */
     *error_code = HASH_OK;
 
-    void *ret = _ht_flat_insert(hashtable, key, entry, SEARCH_NO_REPLACE);
+    int inserted;
+    void *ret = _ht_flat_find_or_insert(hashtable, key, _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed), &inserted, error_code);
 
-    /* Also check if there is a need for rehashing */
-    if(hashtable->entries > UPPER_LIMIT(hashtable->hashtable_sz))
+    /* New key - Copy the entry in its slot */
+    if(inserted)
     {
-        /* Inforn in case of rehashing error - Resize by doubling */
-        *error_code = _ht_flat_resize(hashtable, hashtable->hashtable_sz << 1);
+        memcpy(ret, entry, hashtable->entry_sz);
+        return NULL;
     }
 
     return ret;
@@ -532,23 +780,17 @@ int ht_flat_emplace(flat_hashtable_t *hashtable, const void *key, const void *en
 {
     int status = HASH_OK;
 
-    /* Check user input */
-    if(HT_UNLIKELY(!key || !entry || !hashtable))
+    /* Check user input - Bounded caches insert only through put() */
+    if(HT_UNLIKELY(!key || !entry || !hashtable || hashtable->max_entries))
         return HASH_WRONG_ARGUMENT;
 
-    void *ret = _ht_flat_insert(hashtable, key, entry, SEARCH_NO_REPLACE);
+    int inserted;
+    void *ret = _ht_flat_find_or_insert(hashtable, key, _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed), &inserted, &status);
 
-    /* In case of replace we can directly replace the entry after the search */
+    /* Either a new or an existing entry - Replaced with a single copy */
     if(ret)
         memcpy(ret, entry, hashtable->entry_sz);
 
-    /* Also check if there is a need for rehashing */
-    if(hashtable->entries > UPPER_LIMIT(hashtable->hashtable_sz))
-    {
-        /* Inforn in case of rehashing error - Resize by doubling */
-        status = _ht_flat_resize(hashtable, hashtable->hashtable_sz << 1);
-    }
-
     return status;
 }
 
@@ -560,10 +802,10 @@ int ht_flat_delete(flat_hashtable_t *hashtable, const void *key)
     if(HT_UNLIKELY(!key || !hashtable))
         return HASH_WRONG_ARGUMENT;
 
-    ret = _ht_flat_delete(hashtable, key);
+    ret = _ht_flat_delete(hashtable, key, _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed));
 
-    /* Also check if there is a need for rehashing */
-    if(hashtable->entries < LOWER_LIMIT(hashtable->hashtable_sz))
+    /* Also check if there is a need for rehashing - Bounded caches never resize */
+    if(hashtable->entries < LOWER_LIMIT(hashtable->hashtable_sz) && !hashtable->max_entries)
     {
         /* Inforn in case of rehashing error - Resize by halving */
         if(hashtable->hashtable_sz != (2 * GROUP_SIZE))
@@ -573,6 +815,88 @@ int ht_flat_delete(flat_hashtable_t *hashtable, const void *key)
     return ret;
 }
 
+size_t ht_flat_erase_if(flat_hashtable_t *hashtable, int (*pred)(const void *key, void *entry, void *ctx), void *ctx)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!pred || !hashtable))
+        return 0;
+
+    const size_t step = hashtable->step;
+    const size_t key_sz = hashtable->key_sz;
+    char *table = hashtable->table;
+    size_t erased = 0;
+
+    /* Walk every group once */
+    for(size_t i = 0; i < hashtable->hashtable_sz; i += GROUP_SIZE)
+    {
+        uint8_t *bitmap_pos = &hashtable->bitmap[i];
+        uint16_t valid_mask = ~_ht_and_mask(bitmap_pos, HIGH_BIT_MASK);
+
+        /* Decided once per group - Probing never stops at a group without empty slots */
+        const uint8_t erased_ctrl = _ht_eq_mask(bitmap_pos, ENTRY_EMPTY) ? ENTRY_EMPTY : ENTRY_DELETED;
+
+        while(valid_mask)
+        {
+            size_t pos = _get_first_set_bit_pos(valid_mask);
+            size_t idx = (i + pos) * step;
+
+            if(pred(&table[idx], &table[idx + key_sz], ctx))
+            {
+                bitmap_pos[pos] = erased_ctrl;
+                hashtable->deleted += (erased_ctrl == ENTRY_DELETED);
+                erased++;
+            }
+
+            /* Unset this entry */
+            valid_mask ^= 1 << pos;
+        }
+    }
+
+    hashtable->entries -= erased;
+    HT_STAT_ADD(hashtable, deletes, erased);
+
+    /* A single resize for all the erased entries - Bounded caches never resize */
+    if(erased && !hashtable->max_entries)
+    {
+        size_t new_sz = _get_shrink_capacity(hashtable->entries, hashtable->hashtable_sz);
+
+        if(new_sz != hashtable->hashtable_sz)
+            _ht_flat_resize(hashtable, new_sz);
+    }
+
+    return erased;
+}
+
+int ht_flat_clear(flat_hashtable_t *hashtable, size_t retain_entries)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!hashtable))
+        return HASH_WRONG_ARGUMENT;
+
+    /* Reset the control bytes and the state - The arrays are kept */
+    memset(hashtable->bitmap, ENTRY_EMPTY, hashtable->hashtable_sz * sizeof(uint8_t));
+    hashtable->entries = 0;
+    hashtable->deleted = 0;
+    hashtable->clock_hand = 0;
+
+    if(hashtable->ref_bits)
+        memset(hashtable->ref_bits, 0, hashtable->group_num * sizeof(uint16_t));
+
+    hashtable->iterator.iter_state = ITER_NOT_VALID;
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
+
+    /* Release the memory above the retained capacity - Bounded caches never resize */
+    if(retain_entries && !hashtable->max_entries)
+    {
+        const size_t new_sz = _get_capacity_for_entries(retain_entries);
+
+        if(new_sz < hashtable->hashtable_sz)
+            return _ht_flat_resize(hashtable, new_sz);
+    }
+
+    return HASH_OK;
+}
+
 void ht_flat_free(flat_hashtable_t *hashtable)
 {
     /* Nothing to free, return */
@@ -580,6 +904,7 @@ void ht_flat_free(flat_hashtable_t *hashtable)
         return;
 
     /* Free the tables and the structure itself */
+    free(hashtable->ref_bits);
     free(hashtable->bitmap);
     free(hashtable->table);
     free(hashtable);
@@ -589,6 +914,7 @@ flat_hashtable_tuple_t ht_flat_start_it(flat_hashtable_t *hashtable)
 {
     /* Iterator standard initialization */
     flat_hashtable_tuple_t ret_iter = { .entry = NULL, .key = NULL };
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
 
     hashtable->iterator.iter_state = ITER_NOT_VALID;
 
@@ -601,6 +927,7 @@ flat_hashtable_tuple_t ht_flat_start_it(flat_hashtable_t *hashtable)
 
         size_t pos = _get_first_set_bit_pos(hashtable->iterator.cur_group_mask);
         hashtable->iterator.cur_group_mask ^= 1 << pos;
+        hashtable->iterator.cur_idx = (hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos;
 
         size_t idx = ((hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos) * hashtable->step;
         ret_iter.key = &hashtable->table[idx];
@@ -614,6 +941,7 @@ flat_hashtable_tuple_t ht_flat_next_it(flat_hashtable_t *hashtable)
 {
     /* Iterator standard initialization */
     flat_hashtable_tuple_t ret_iter = { .entry = NULL, .key = NULL };
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
 
     if(hashtable->iterator.iter_state == ITER_VALID)
     {
@@ -633,6 +961,7 @@ flat_hashtable_tuple_t ht_flat_next_it(flat_hashtable_t *hashtable)
 
         size_t pos = _get_first_set_bit_pos(hashtable->iterator.cur_group_mask);
         hashtable->iterator.cur_group_mask ^= 1 << pos;
+        hashtable->iterator.cur_idx = (hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos;
 
         size_t idx = ((hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos) * hashtable->step;
         ret_iter.key = &hashtable->table[idx];
@@ -646,6 +975,7 @@ flat_hashtable_tuple_t ht_flat_prev_it(flat_hashtable_t *hashtable)
 {
     /* Iterator standard initialization */
     flat_hashtable_tuple_t ret_iter = { .entry = NULL, .key = NULL };
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
 
     if(hashtable->iterator.iter_state == ITER_VALID)
     {
@@ -664,6 +994,7 @@ flat_hashtable_tuple_t ht_flat_prev_it(flat_hashtable_t *hashtable)
 
         size_t pos = _get_first_set_bit_pos(hashtable->iterator.cur_group_mask);
         hashtable->iterator.cur_group_mask ^= 1 << pos;
+        hashtable->iterator.cur_idx = (hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos;
 
         size_t idx = ((hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos) * hashtable->step;
         ret_iter.key = &hashtable->table[idx];
@@ -677,6 +1008,7 @@ flat_hashtable_tuple_t ht_flat_end_it(flat_hashtable_t *hashtable)
 {
     /* Iterator standard initialization */
     flat_hashtable_tuple_t ret_iter = { .entry = NULL, .key = NULL };
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
 
     hashtable->iterator.iter_state = ITER_VALID;
 
@@ -689,6 +1021,7 @@ flat_hashtable_tuple_t ht_flat_end_it(flat_hashtable_t *hashtable)
 
         size_t pos = _get_first_set_bit_pos(hashtable->iterator.cur_group_mask);
         hashtable->iterator.cur_group_mask ^= 1 << pos;
+        hashtable->iterator.cur_idx = (hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos;
 
         size_t idx = ((hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos) * hashtable->step;
         ret_iter.key = &hashtable->table[idx];
@@ -698,32 +1031,630 @@ flat_hashtable_tuple_t ht_flat_end_it(flat_hashtable_t *hashtable)
     return ret_iter;
 }
 
-size_t ht_flat_get_entries(flat_hashtable_t *hashtable)
+int ht_flat_erase_it(flat_hashtable_t *hashtable)
 {
-    return hashtable->entries;
+    /* Check user input */
+    if(HT_UNLIKELY(!hashtable))
+        return HASH_WRONG_ARGUMENT;
+
+    const size_t idx = hashtable->iterator.cur_idx;
+
+    /* No current element or already erased */
+    if(idx == SLOT_NOT_FOUND || (hashtable->bitmap[idx] & HIGH_BIT_MASK))
+        return HASH_ENTRY_NOT_EXISTS;
+
+    /* The rest of the group is already in the iterator mask - Shrinking is left to the next delete */
+    _ht_flat_erase_slot(hashtable, idx);
+
+    return HASH_OK;
 }
 
-size_t ht_flat_get_capacity(flat_hashtable_t *hashtable)
+void *ht_flat_find_or_insert(flat_hashtable_t *hashtable, const void *key, int *inserted)
 {
-    return hashtable->hashtable_sz;
+    int status = HASH_OK;
+
+    /* Check user input - Bounded caches insert only through put() */
+    if(HT_UNLIKELY(!key || !hashtable || !inserted || hashtable->max_entries))
+        return NULL;
+
+    return _ht_flat_find_or_insert(hashtable, key, _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed), inserted, &status);
 }
 
-double ht_flat_get_load_factor(flat_hashtable_t *hashtable)
+/************************************ Prepared Routines for Flat ************************************/
+
+ht_probe_t ht_flat_prepare(flat_hashtable_t *hashtable, const void *key)
 {
-    return ((double)hashtable->entries) / hashtable->hashtable_sz;
+    ht_probe_t probe = { .hash = 0, .seed = 0, .key_len = 0, .full_hash = 0 };
+
+    /* Check user input - An empty handle is returned */
+    if(HT_UNLIKELY(!key || !hashtable))
+        return probe;
+
+    probe.hash = _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed);
+    probe.seed = hashtable->hash_seed;
+    probe.key_len = hashtable->key_sz;
+
+    /* Bring the metadata group and the first slots of the group closer */
+    size_t i = ((probe.hash >> GROUP_H1_SHIFT) & (hashtable->group_num - 1)) * GROUP_SIZE;
+    HT_PREFETCH(&hashtable->bitmap[i]);
+    HT_PREFETCH(&hashtable->table[i * hashtable->step]);
+
+    return probe;
 }
 
-void ht_flat_print_mem_usage(flat_hashtable_t *hashtable)
+void *ht_flat_search_prepared(flat_hashtable_t *hashtable, const void *key, ht_probe_t probe)
 {
-    size_t bitmap_sz = hashtable->hashtable_sz;
-    size_t hashtable_sz = hashtable->hashtable_sz * (hashtable->key_sz + hashtable->entry_sz);
-    size_t manager_structure_mem = sizeof(flat_hashtable_t);
+    /* Check user input */
+    if(HT_UNLIKELY(!key || !hashtable))
+        return NULL;
 
-    size_t valid_entries = hashtable->entries * (hashtable->key_sz + hashtable->entry_sz);
-    size_t valid_bitmap = hashtable->entries;
+    /* Different seed - The hash is not valid for this table */
+    if(HT_UNLIKELY(probe.seed != hashtable->hash_seed))
+        probe.hash = _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed);
 
-    size_t total_memory = bitmap_sz + hashtable_sz + manager_structure_mem;
-    size_t used_memory = valid_entries + valid_bitmap + manager_structure_mem;
+    return _ht_flat_search(hashtable, key, probe.hash);
+}
+
+void *ht_flat_insert_prepared(flat_hashtable_t *hashtable, const void *key, const void *entry, ht_probe_t probe, int *error_code)
+{
+    /* Check user input - Bounded caches insert only through put() */
+    if(HT_UNLIKELY(!key || !entry || !hashtable || !error_code || hashtable->max_entries))
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
+    }
+
+    /* Set error code */
+    *error_code = HASH_OK;
+
+    /* Different seed - The hash is not valid for this table */
+    if(HT_UNLIKELY(probe.seed != hashtable->hash_seed))
+        probe.hash = _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed);
+
+    int inserted;
+    void *ret = _ht_flat_find_or_insert(hashtable, key, probe.hash, &inserted, error_code);
+
+    /* New key - Copy the entry in its slot */
+    if(inserted)
+    {
+        memcpy(ret, entry, hashtable->entry_sz);
+        return NULL;
+    }
+
+    return ret;
+}
+
+int ht_flat_delete_prepared(flat_hashtable_t *hashtable, const void *key, ht_probe_t probe)
+{
+    int ret = HASH_OK;
+
+    /* Check user input */
+    if(HT_UNLIKELY(!key || !hashtable))
+        return HASH_WRONG_ARGUMENT;
+
+    /* Different seed - The hash is not valid for this table */
+    if(HT_UNLIKELY(probe.seed != hashtable->hash_seed))
+        probe.hash = _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed);
+
+    ret = _ht_flat_delete(hashtable, key, probe.hash);
+
+    /* Also check if there is a need for rehashing - Bounded caches never resize */
+    if(hashtable->entries < LOWER_LIMIT(hashtable->hashtable_sz) && !hashtable->max_entries)
+    {
+        /* Inforn in case of rehashing error - Resize by halving */
+        if(hashtable->hashtable_sz != (2 * GROUP_SIZE))
+            ret = _ht_flat_resize(hashtable, hashtable->hashtable_sz >> 1);
+    }
+
+    return ret;
+}
+
+/************************************ Multimap Routines for Flat ************************************/
+
+int ht_flat_multi_insert(flat_hashtable_t *hashtable, const void *key, const void *entry)
+{
+    int status = HASH_OK;
+
+    /* Check user input - Bounded caches insert only through put() */
+    if(HT_UNLIKELY(!key || !entry || !hashtable || hashtable->max_entries))
+        return HASH_WRONG_ARGUMENT;
+
+    /* No search - Duplicates take their own slot in the probe sequence */
+    _ht_flat_insert(hashtable, key, entry, _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed), NO_SEARCH);
+    HT_STAT_INC(hashtable, inserts);
+
+    /* Also check if there is a need for rehashing */
+    if(hashtable->entries > UPPER_LIMIT(hashtable->hashtable_sz))
+    {
+        /* Inforn in case of rehashing error - Resize by doubling */
+        status = _ht_flat_resize(hashtable, hashtable->hashtable_sz << 1);
+    }
+
+    return status;
+}
+
+size_t ht_flat_equal_range(flat_hashtable_t *hashtable, const void *key, void **entries, size_t max_entries)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!key || !hashtable))
+        return 0;
+
+    /* Constants */
+    const size_t step = hashtable->step;
+    const size_t group_mask = hashtable->group_num - 1; /* Now this becomes a mask */
+    const char *table = hashtable->table;
+
+    /* Metadata for the given key */
+    const size_t hash = _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed);
+    const uint8_t bitmap_ctrl = hash & GROUP_H2_MASK;
+
+    /* Starting group index */
+    size_t group_idx = (hash >> GROUP_H1_SHIFT) & group_mask;
+    size_t matches = 0;
+#ifndef SPARSE_LIN_PROBE
+    size_t probe_step = 1;
+#endif
+
+    /* Duplicates all lie before the first group with an empty slot */
+    while(1)
+    {
+        size_t i = group_idx * GROUP_SIZE;
+
+        HT_STAT_INC(hashtable, groups_probed);
+
+        /* Create the masks */
+        uint8_t *bitmap_pos = &hashtable->bitmap[i];
+        uint16_t eq_mask = _ht_eq_mask(bitmap_pos, bitmap_ctrl);
+        uint16_t empty_mask = _ht_eq_mask(bitmap_pos, ENTRY_EMPTY);
+
+        /* Collect every match of the group */
+        while(eq_mask)
+        {
+            size_t pos = _get_first_set_bit_pos(eq_mask);
+
+            if(COMP_KEY_CB(&table[(i + pos) * step], key, hashtable->key_sz))
+            {
+                if(matches < max_entries)
+                    entries[matches] = (void *)&table[(i + pos) * step + hashtable->key_sz];
+
+                matches++;
+            }
+
+            /* Unset this entry */
+            eq_mask ^= 1 << pos;
+        }
+
+        /* Search stop condition */
+        if(empty_mask)
+        {
+            HT_STAT_INC(hashtable, searches);
+            HT_STAT_ADD(hashtable, hits, matches != 0);
+            HT_STAT_ADD(hashtable, misses, matches == 0);
+            return matches;
+        }
+
+/* Probe */
+#ifdef SPARSE_LIN_PROBE
+        group_idx = (group_idx + 1) & group_mask;
+#else
+        group_idx = (group_idx + probe_step) & group_mask;
+        probe_step++;
+#endif
+    }
+
+    return matches; /* Suppress compiler warnings */
+}
+
+size_t ht_flat_count(flat_hashtable_t *hashtable, const void *key)
+{
+    return ht_flat_equal_range(hashtable, key, NULL, 0);
+}
+
+size_t ht_flat_erase_all(flat_hashtable_t *hashtable, const void *key)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!key || !hashtable))
+        return 0;
+
+    /* Constants */
+    const size_t step = hashtable->step;
+    const size_t group_mask = hashtable->group_num - 1; /* Now this becomes a mask */
+    const size_t hash = _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed);
+    const uint8_t bitmap_ctrl = hash & GROUP_H2_MASK;
+
+    /* Starting group index */
+    char *table = hashtable->table;
+    size_t group_idx = (hash >> GROUP_H1_SHIFT) & group_mask;
+    size_t erased = 0;
+#ifndef SPARSE_LIN_PROBE
+    size_t probe_step = 1;
+#endif
+
+    while(1)
+    {
+        size_t i = group_idx * GROUP_SIZE;
+
+        HT_STAT_INC(hashtable, groups_probed);
+
+        /* Create the masks */
+        uint8_t *bitmap_pos = &hashtable->bitmap[i];
+        uint16_t eq_mask = _ht_eq_mask(bitmap_pos, bitmap_ctrl);
+        uint16_t empty_mask = _ht_eq_mask(bitmap_pos, ENTRY_EMPTY);
+
+        while(eq_mask)
+        {
+            size_t pos = _get_first_set_bit_pos(eq_mask);
+
+            if(COMP_KEY_CB(&table[(i + pos) * step], key, hashtable->key_sz))
+            {
+                /* Put a tombstone only if there are no empty entries in the group */
+                hashtable->bitmap[i + pos] = (empty_mask) ? ENTRY_EMPTY : ENTRY_DELETED;
+                hashtable->deleted += !empty_mask;
+                hashtable->entries--;
+                erased++;
+            }
+
+            /* Unset this entry */
+            eq_mask ^= 1 << pos;
+        }
+
+        /* Stop condition */
+        if(empty_mask)
+            break;
+
+/* Probe */
+#ifdef SPARSE_LIN_PROBE
+        group_idx = (group_idx + 1) & group_mask;
+#else
+        group_idx = (group_idx + probe_step) & group_mask;
+        probe_step++;
+#endif
+    }
+
+    HT_STAT_ADD(hashtable, deletes, erased);
+
+    /* One resize check for all the erased entries - Resize by halving */
+    if(erased && hashtable->entries < LOWER_LIMIT(hashtable->hashtable_sz) && hashtable->hashtable_sz != (2 * GROUP_SIZE) && !hashtable->max_entries)
+        _ht_flat_resize(hashtable, hashtable->hashtable_sz >> 1);
+
+    return erased;
+}
+
+/************************************ Merge Routines for Flat ************************************/
+
+int ht_flat_merge(flat_hashtable_t *dst, flat_hashtable_t *src, ht_merge_policy_t policy,
+                  void (*combine)(void *dst_entry, const void *src_entry, void *ctx), void *ctx)
+{
+    /* Check user input - Same layout is needed and bounded caches cannot grow */
+    if(HT_UNLIKELY(!dst || !src || dst == src || dst->max_entries || (policy == HT_MERGE_COMBINE && !combine)))
+        return HASH_WRONG_ARGUMENT;
+
+    if(HT_UNLIKELY(dst->key_sz != src->key_sz || dst->entry_sz != src->entry_sz))
+        return HASH_WRONG_ARGUMENT;
+
+    int error_code = HASH_OK;
+    const size_t key_sz = src->key_sz, step = src->step;
+
+    /* Empty destination with the same seed - Every slot keeps its position. The seed is never
+     * adopted, since tables filled by iteration from a same seed table cluster badly */
+    if(!dst->entries && dst->hash_seed == src->hash_seed)
+    {
+        if(dst->hashtable_sz != src->hashtable_sz && (error_code = _ht_flat_resize(dst, src->hashtable_sz)) != HASH_OK)
+            return error_code;
+
+        memcpy(dst->bitmap, src->bitmap, src->hashtable_sz * sizeof(uint8_t));
+        memcpy(dst->table, src->table, src->hashtable_sz * step);
+        dst->entries = src->entries;
+        dst->deleted = src->deleted;
+        HT_STAT_ADD(dst, inserts, src->entries);
+
+        return HASH_OK;
+    }
+
+    /* Pre-size for the worst case (no common keys) - No resize happens midway */
+    if((error_code = ht_flat_reserve(dst, dst->entries + src->entries)) != HASH_OK)
+        return error_code;
+
+    for(size_t i = 0; i < src->hashtable_sz; i += GROUP_SIZE)
+    {
+        uint16_t valid_mask = ~_ht_and_mask(&src->bitmap[i], HIGH_BIT_MASK);
+
+        while(valid_mask)
+        {
+            size_t pos = _get_first_set_bit_pos(valid_mask);
+            const char *key = &src->table[(i + pos) * step];
+            const char *entry = key + key_sz;
+            int inserted;
+
+            /* Single probe in the destination */
+            void *dst_entry = _ht_flat_find_or_insert(dst, key, _ht_flat_hasher(key, key_sz, dst->hash_seed), &inserted, &error_code);
+
+            if(inserted || policy == HT_MERGE_OVERWRITE)
+                memcpy(dst_entry, entry, dst->entry_sz);
+            else if(policy == HT_MERGE_COMBINE)
+                combine(dst_entry, entry, ctx);
+
+            /* Unset this entry */
+            valid_mask ^= 1 << pos;
+        }
+    }
+
+    return HASH_OK;
+}
+
+/************************************ Clone Routines for Flat ************************************/
+
+flat_hashtable_t *ht_flat_clone(flat_hashtable_t *src, int *error_code)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!src || !error_code))
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
+    }
+
+    /* Identical capacity and layout */
+    flat_hashtable_t *hashtable = _ht_flat_create(src->hashtable_sz, src->entry_sz, src->key_sz, error_code);
+
+    if(!hashtable)
+        return NULL;
+
+    if(src->ref_bits)
+    {
+        hashtable->ref_bits = malloc(src->group_num * sizeof(uint16_t));
+
+        if(!hashtable->ref_bits)
+        {
+            *error_code = HASH_CREATE_MEM_ALLOC;
+            ht_flat_free(hashtable);
+            return NULL;
+        }
+
+        memcpy(hashtable->ref_bits, src->ref_bits, src->group_num * sizeof(uint16_t));
+    }
+
+    /* Bulk copy - Same seed so every slot stays in place */
+    memcpy(hashtable->bitmap, src->bitmap, src->hashtable_sz * sizeof(uint8_t));
+    memcpy(hashtable->table, src->table, src->hashtable_sz * src->step);
+    hashtable->entries = src->entries;
+    hashtable->deleted = src->deleted;
+    hashtable->hash_seed = src->hash_seed;
+    hashtable->max_entries = src->max_entries;
+    hashtable->clock_hand = src->clock_hand;
+
+    return hashtable;
+}
+
+/************************************ Cache Routines for Flat ************************************/
+
+flat_hashtable_t *ht_flat_cache_create(size_t max_entries, size_t entry_sz, size_t key_sz, int *error_code)
+{
+    /* Check input by the user - Necessary inputs */
+    if(!max_entries || !entry_sz || !key_sz)
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
+    }
+
+    /* The capacity is fixed so that the maximum entries never exceed the upper limit. Half
+     * of them is kept as headroom for the tombstones of the evictions, so that the in place
+     * rehashes that clear them are amortized over many puts */
+    flat_hashtable_t *hashtable = _ht_flat_create(_get_capacity_for_entries(max_entries + (max_entries >> 1)), entry_sz, key_sz, error_code);
+
+    if(!hashtable)
+        return NULL;
+
+    hashtable->ref_bits = calloc(hashtable->group_num, sizeof(uint16_t));
+
+    if(!hashtable->ref_bits)
+    {
+        *error_code = HASH_CREATE_MEM_ALLOC;
+        ht_flat_free(hashtable);
+        return NULL;
+    }
+
+    hashtable->max_entries = max_entries;
+
+    return hashtable;
+}
+
+flat_hashtable_t *ht_flat_cache_create_bytes(size_t max_bytes, size_t entry_sz, size_t key_sz, int *error_code)
+{
+    /* Slot, metadata byte and reference bit of each entry */
+    const double slot_cost = (key_sz + entry_sz) + 1 + 0.125;
+    size_t hashtable_sz = 2 * GROUP_SIZE;
+
+    /* Check input by the user - Necessary inputs (Also has to fit the minimum size) */
+    if(!entry_sz || !key_sz || max_bytes < (2 * GROUP_SIZE) * slot_cost)
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
+    }
+
+    /* Largest table that fits in the budget */
+    while((hashtable_sz << 1) * slot_cost <= max_bytes)
+        hashtable_sz <<= 1;
+
+    /* Half of the table - The headroom of create() then fits in the same capacity */
+    return ht_flat_cache_create(hashtable_sz >> 1, entry_sz, key_sz, error_code);
+}
+
+void *ht_flat_cache_get(flat_hashtable_t *hashtable, const void *key)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!key || !hashtable || !hashtable->max_entries))
+        return NULL;
+
+    const size_t idx = _ht_flat_find(hashtable, key, _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed));
+
+    if(idx == SLOT_NOT_FOUND)
+        return NULL;
+
+    /* Hit - Only the reference bit is set */
+    hashtable->ref_bits[idx >> GROUP_SIZE_SHIFT] |= 1 << (idx & (GROUP_SIZE - 1));
+
+    return (void *)&hashtable->table[idx * hashtable->step + hashtable->key_sz];
+}
+
+int ht_flat_cache_put(flat_hashtable_t *hashtable, const void *key, const void *entry)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!key || !entry || !hashtable || !hashtable->max_entries))
+        return HASH_WRONG_ARGUMENT;
+
+    const size_t hash = _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed);
+    int found;
+    size_t idx = _ht_flat_find_or_free(hashtable, key, hash, &found);
+
+    /* Replace the existing entry */
+    if(found)
+    {
+        memcpy(&hashtable->table[idx * hashtable->step + hashtable->key_sz], entry, hashtable->entry_sz);
+        hashtable->ref_bits[idx >> GROUP_SIZE_SHIFT] |= 1 << (idx & (GROUP_SIZE - 1));
+        return HASH_OK;
+    }
+
+    /* Make room for the new entry - The free slot found stays free */
+    if(hashtable->entries >= hashtable->max_entries)
+        _ht_flat_cache_evict(hashtable);
+
+    memcpy(_ht_flat_place(hashtable, idx, hash, key), entry, hashtable->entry_sz);
+    HT_STAT_INC(hashtable, inserts);
+    hashtable->ref_bits[idx >> GROUP_SIZE_SHIFT] |= 1 << (idx & (GROUP_SIZE - 1));
+
+    /* Too many tombstones - Rehash in place, so that probes always meet an empty slot */
+    if(hashtable->entries + hashtable->deleted > UPPER_LIMIT(hashtable->hashtable_sz))
+        return _ht_flat_resize(hashtable, hashtable->hashtable_sz);
+
+    return HASH_OK;
+}
+
+/************************************ Set Routines for Flat ************************************/
+
+flat_hashtable_t *ht_flat_set_create(size_t hashtable_sz, size_t key_sz, int *error_code)
+{
+    /* Check input by the user - Necessary inputs */
+    if(!hashtable_sz || !key_sz)
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
+    }
+
+    /* A set is a table without payload - Slots hold only the key */
+    return _ht_flat_create(_get_capacity_for_entries(hashtable_sz), 0, key_sz, error_code);
+}
+
+int ht_flat_set_contains(flat_hashtable_t *hashtable, const void *key)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!key || !hashtable))
+        return 0;
+
+    return _ht_flat_search(hashtable, key, _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed)) != NULL;
+}
+
+int ht_flat_set_add(flat_hashtable_t *hashtable, const void *key, int *error_code)
+{
+    /* Check user input - Only payload-free tables are accepted */
+    if(HT_UNLIKELY(!key || !hashtable || !error_code || hashtable->entry_sz))
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return 0;
+    }
+
+    /* Set error code */
+    *error_code = HASH_OK;
+
+    /* Nothing is copied for the entry, since its size is 0 */
+    int inserted;
+    _ht_flat_find_or_insert(hashtable, key, _ht_flat_hasher(key, hashtable->key_sz, hashtable->hash_seed), &inserted, error_code);
+
+    return inserted;
+}
+
+int ht_flat_set_remove(flat_hashtable_t *hashtable, const void *key)
+{
+    return ht_flat_delete(hashtable, key);
+}
+
+const void *ht_flat_set_start_it(flat_hashtable_t *hashtable)
+{
+    return ht_flat_start_it(hashtable).key;
+}
+
+const void *ht_flat_set_next_it(flat_hashtable_t *hashtable)
+{
+    return ht_flat_next_it(hashtable).key;
+}
+
+int ht_flat_reserve(flat_hashtable_t *hashtable, size_t entries)
+{
+    /* Check user input - Bounded caches have a fixed capacity */
+    if(HT_UNLIKELY(!hashtable || hashtable->max_entries))
+        return HASH_WRONG_ARGUMENT;
+
+    const size_t new_sz = _get_capacity_for_entries(entries);
+
+    /* Only grows */
+    if(new_sz <= hashtable->hashtable_sz)
+        return HASH_OK;
+
+    return _ht_flat_resize(hashtable, new_sz);
+}
+
+int ht_flat_shrink_to_fit(flat_hashtable_t *hashtable)
+{
+    /* Check user input - Bounded caches have a fixed capacity */
+    if(HT_UNLIKELY(!hashtable || hashtable->max_entries))
+        return HASH_WRONG_ARGUMENT;
+
+    const size_t new_sz = _get_capacity_for_entries(hashtable->entries);
+
+    /* Rehashing in the same size also clears the tombstones */
+    if(new_sz > hashtable->hashtable_sz || (new_sz == hashtable->hashtable_sz && !hashtable->deleted))
+        return HASH_OK;
+
+    return _ht_flat_resize(hashtable, new_sz);
+}
+
+int ht_flat_reseed(flat_hashtable_t *hashtable, uint64_t seed)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!hashtable))
+        return HASH_WRONG_ARGUMENT;
+
+    /* Rehash in place with the new seed */
+    hashtable->hash_seed = seed;
+
+    return _ht_flat_resize(hashtable, hashtable->hashtable_sz);
+}
+
+size_t ht_flat_get_entries(flat_hashtable_t *hashtable)
+{
+    return hashtable->entries;
+}
+
+size_t ht_flat_get_capacity(flat_hashtable_t *hashtable)
+{
+    return hashtable->hashtable_sz;
+}
+
+double ht_flat_get_load_factor(flat_hashtable_t *hashtable)
+{
+    return ((double)hashtable->entries) / hashtable->hashtable_sz;
+}
+
+void ht_flat_print_mem_usage(flat_hashtable_t *hashtable)
+{
+    size_t bitmap_sz = hashtable->hashtable_sz;
+    size_t hashtable_sz = hashtable->hashtable_sz * (hashtable->key_sz + hashtable->entry_sz);
+    size_t manager_structure_mem = sizeof(flat_hashtable_t);
+
+    size_t valid_entries = hashtable->entries * (hashtable->key_sz + hashtable->entry_sz);
+    size_t valid_bitmap = hashtable->entries;
+
+    size_t total_memory = bitmap_sz + hashtable_sz + manager_structure_mem;
+    size_t used_memory = valid_entries + valid_bitmap + manager_structure_mem;
 
     printf("******SPARSE_NODE_STAT INFO******\n");
     printf("Entries: %ld - Capacity: %ld\n", hashtable->entries, hashtable->hashtable_sz);
@@ -731,3 +1662,60 @@ void ht_flat_print_mem_usage(flat_hashtable_t *hashtable)
     printf("Effective mem used(bytes): %ld\n", used_memory);
     printf("Memory util (bytes): %f\n", (double)used_memory / total_memory);
 }
+
+int ht_flat_probe_stats(flat_hashtable_t *hashtable, ht_probe_stats_t *stats)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!hashtable || !stats))
+        return HASH_WRONG_ARGUMENT;
+
+#ifdef SPARSE_LIN_PROBE
+    const int lin_probe = 1;
+#else
+    const int lin_probe = 0;
+#endif
+    const size_t group_mask = hashtable->group_num - 1;
+
+    memset(stats, 0, sizeof(ht_probe_stats_t));
+    stats->entries = hashtable->entries;
+    stats->capacity = hashtable->hashtable_sz;
+
+    /* Every resident key is rehashed to find the groups its lookup visits */
+    for(size_t i = 0; i < hashtable->group_num; i++)
+    {
+        uint16_t valid_entries_mask = ~(_ht_and_mask(&hashtable->bitmap[i * GROUP_SIZE], HIGH_BIT_MASK));
+
+        while(valid_entries_mask)
+        {
+            size_t pos = _get_first_set_bit_pos(valid_entries_mask);
+            size_t hash = _ht_flat_hasher(&hashtable->table[(i * GROUP_SIZE + pos) * hashtable->step], hashtable->key_sz, hashtable->hash_seed);
+
+            _ht_probe_stats_add(stats, _ht_probe_len((hash >> GROUP_H1_SHIFT) & group_mask, i, group_mask, lin_probe));
+
+            /* Unset this entry */
+            valid_entries_mask ^= 1 << pos;
+        }
+    }
+
+    if(stats->entries)
+        stats->avg_probe /= stats->entries;
+
+    _ht_probe_stats_groups(stats, hashtable->bitmap, hashtable->group_num, lin_probe);
+
+    return HASH_OK;
+}
+
+int ht_flat_get_stats(flat_hashtable_t *hashtable, ht_op_stats_t *stats)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!hashtable || !stats))
+        return HASH_WRONG_ARGUMENT;
+
+#ifdef HT_STATS
+    *stats = hashtable->stats;
+#else
+    memset(stats, 0, sizeof(ht_op_stats_t));
+#endif
+
+    return HASH_OK;
+}
@@ -4,6 +4,9 @@
 #include <stddef.h>
 #include <stdlib.h>
 
+/* Types shared by both variants */
+#include "sparse_hashtable_types.h"
+
 /* Define for external use */
 typedef struct flat_hashtable_struct flat_hashtable_t;
 
@@ -100,8 +103,8 @@ typedef struct flat_hashtable_tuple_struct
  *    -> Consider mystruct {int a, char *str} -> sizeof(mystruct) = 8
  * And inside the hashtable the entry will be the str pointer and not the string itself.
  *
- * Hashtable may not be the exact size as the user requested and may allocate extra memory
- * for internal reasons.
+ * The size is the number of expected entries, so that many can be inserted without
+ * rehashing. Hashtable may allocate extra memory for internal reasons.
  */
 flat_hashtable_t *ht_flat_create(size_t hashtable_sz, size_t entry_sz, size_t key_sz, int *error_code);
 
@@ -170,6 +173,25 @@ void *ht_flat_insert(flat_hashtable_t *hashtable, const void *key, const void *e
  * */
 int ht_flat_emplace(flat_hashtable_t *hashtable, const void *key, const void *entry);
 
+/* **** ht_flat_find_or_insert ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *hashtable : The hashtable structure manager
+ *        - const void *key             : The key to be searched or inserted
+ *        - int *inserted               : Set to 1 if the key was inserted, else 0
+ * @ Return value:
+ *        - void *entry                 : Pointer to the entry of the key or NULL
+ * @ Description:
+ *
+ * Searches for the key and if it does not exist inserts it, with a single hash
+ * and a single probe sequence. Returns a pointer to the entry inside the table,
+ * either existing or new, where for new keys the entry is uninitialized so the
+ * user can construct it in place.
+ *
+ * NULL is returned in case of wrong input or rehashing failure.
+ * Return may not be valid after insertion or delete.
+ * */
+void *ht_flat_find_or_insert(flat_hashtable_t *hashtable, const void *key, int *inserted);
+
 /* **** ht_flat_delete ****
  * @ Input arguments:
  *        - flat_hashtable_t *hashtable : The hashtable structure manager
@@ -182,6 +204,229 @@ int ht_flat_emplace(flat_hashtable_t *hashtable, const void *key, const void *en
  * */
 int ht_flat_delete(flat_hashtable_t *hashtable, const void *key);
 
+/* **** ht_flat_erase_if ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *hashtable : The hashtable structure manager
+ *        - int (*pred)(...)            : Predicate called with the key, the entry and ctx
+ *        - void *ctx                   : User context passed to the predicate
+ * @ Return value:
+ *        - size_t erased               : Number of erased entries
+ * @ Description:
+ *
+ * Erases every entry for which the predicate returns non zero. The groups are
+ * walked once and the slots are marked in place, without re-hashing or probing.
+ * At most one resize is performed at the end. The predicate must not modify the table.
+ */
+size_t ht_flat_erase_if(flat_hashtable_t *hashtable, int (*pred)(const void *key, void *entry, void *ctx), void *ctx);
+
+/* **** ht_flat_clear ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *hashtable : The hashtable structure manager
+ *        - size_t retain_entries       : Capacity to keep, in entries (0 keeps everything)
+ * @ Return value:
+ *        - int error_code              : The error code, in case of failure
+ * @ Description:
+ *
+ * Removes all the entries and keeps the allocated arrays, so the table can be
+ * reused without allocations or regrowing. If the table is larger than needed for
+ * retain_entries, the extra memory is released.
+ */
+int ht_flat_clear(flat_hashtable_t *hashtable, size_t retain_entries);
+
+/* ------------------------ Prepared operations ------------------------ */
+
+/* **** ht_flat_prepare ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *hashtable : The hashtable structure manager
+ *        - const void *key             : The key to be prepared
+ * @ Return value:
+ *        - ht_probe_t probe            : Handle for the prepared operations
+ * @ Description:
+ *
+ * First phase of a two-phase lookup. Computes the hash of the key and prefetches
+ * the group it maps to, so the memory latency can be hidden behind other work
+ * before the prepared search/insert/delete are called with the same key.
+ *
+ * The prepared operations work like their simple versions, without hashing the
+ * key again. The handle stays valid after insertion or delete and can also be
+ * used on other tables with the same key size (the hash is recomputed if the
+ * seed of the table differs).
+ *
+ * A NULL table or key gives an empty handle (all zeros), which is not meant to be used.
+ */
+ht_probe_t ht_flat_prepare(flat_hashtable_t *hashtable, const void *key);
+void *ht_flat_search_prepared(flat_hashtable_t *hashtable, const void *key, ht_probe_t probe);
+void *ht_flat_insert_prepared(flat_hashtable_t *hashtable, const void *key, const void *entry, ht_probe_t probe, int *error_code);
+int ht_flat_delete_prepared(flat_hashtable_t *hashtable, const void *key, ht_probe_t probe);
+
+/* ------------------------ Multimap ------------------------ */
+
+/* **** ht_flat_multi_insert ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *hashtable : The hashtable structure manager
+ *        - const void *key             : The key to be inserted
+ *        - const void *entry           : The entry associated with the key
+ * @ Return value:
+ *        - int error_code              : Error code for the status of the operation
+ * @ Description:
+ *
+ * Inserts the <key, entry> pair even if the key already exists, so identical keys
+ * occupy multiple slots. Search and delete operate on one of the duplicates.
+ * Error code should be checked (in case or rehashing failure).
+ */
+int ht_flat_multi_insert(flat_hashtable_t *hashtable, const void *key, const void *entry);
+
+/* **** ht_flat_equal_range ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *hashtable : The hashtable structure manager
+ *        - const void *key             : The key to be searched
+ *        - void **entries              : Array for the entries found (can be NULL)
+ *        - size_t max_entries          : Size of the entries array
+ * @ Return value:
+ *        - size_t matches              : Number of entries with that key
+ * @ Description:
+ *
+ * Collects the entries of every duplicate of a key in one probe sequence.
+ * At most max_entries are written, but the return is always the total count,
+ * so a larger array can be used if need be.
+ *
+ * Count returns the number of duplicates, erase all deletes every duplicate
+ * of a key (with at most one resize) and returns how many were deleted.
+ * Returns may not be valid after insertion or delete.
+ */
+size_t ht_flat_equal_range(flat_hashtable_t *hashtable, const void *key, void **entries, size_t max_entries);
+size_t ht_flat_count(flat_hashtable_t *hashtable, const void *key);
+size_t ht_flat_erase_all(flat_hashtable_t *hashtable, const void *key);
+
+/* ------------------------ Merge ------------------------ */
+
+/* **** ht_flat_merge ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *dst       : The table that receives the entries
+ *        - flat_hashtable_t *src       : The table whose entries are copied
+ *        - ht_merge_policy_t policy    : What to do with the keys found in both tables
+ *        - void (*combine)(...)        : Combines the source entry into the destination one
+ *        - void *ctx                   : User context passed to the combine callback
+ * @ Return value:
+ *        - int error_code              : The error code, in case of failure
+ * @ Description:
+ *
+ * Copies every entry of src into dst (src is not modified). Both tables must have the
+ * same key and entry sizes. The destination is resized once beforehand from both entry
+ * counts, so each source key costs a single hash and probe. An empty destination with
+ * the same seed (i.e after ht_flat_reseed()) gets a copy of the source arrays, without any
+ * rehashing. The seed of the destination is never changed. Bounded caches cannot be the destination.
+ */
+int ht_flat_merge(flat_hashtable_t *dst, flat_hashtable_t *src, ht_merge_policy_t policy,
+                  void (*combine)(void *dst_entry, const void *src_entry, void *ctx), void *ctx);
+
+/* ------------------------ Clone ------------------------ */
+
+/* **** ht_flat_clone ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *src       : The table to be cloned
+ *        - int *error_code             : The error code, in case of failure
+ * @ Return value:
+ *        - flat_hashtable_t *hashtable : The clone, NULL in case of failure
+ * @ Description:
+ *
+ * Creates an independent copy of the table with the same capacity, seed and layout,
+ * by copying the metadata and the slot arrays as they are (no rehashing).
+ * Bounded caches are cloned along with their CLOCK state.
+ */
+flat_hashtable_t *ht_flat_clone(flat_hashtable_t *src, int *error_code);
+
+/* ------------------------ Bounded cache ------------------------ */
+
+/* **** ht_flat_cache_create ****
+ * @ Input arguments:
+ *        - size_t max_entries/max_bytes : The capacity in entries or in bytes
+ *        - size_t entry_sz              : The size of the entry
+ *        - size_t key_sz                : The size of the key
+ *        - int error_code               : The error code, in case of failure
+ * @ Return value:
+ *        - flat_hashtable_t *hashtable  : The hashtable structure manager
+ * @ Description:
+ *
+ * Creates a hashtable with a fixed capacity that never resizes. When full, put()
+ * evicts an entry based on the CLOCK policy (an entry is evicted only if it was not
+ * referenced since the last sweep of the clock hand).
+ *
+ * The capacity keeps headroom for half the maximum entries, which holds the tombstones
+ * of the evictions. The byte variant picks the largest table within the budget and allows
+ * half of its slots. The tombstones are cleared by a rehash in place every so many puts,
+ * which keeps the reference bits.
+ *
+ * Get works like search() but also marks the entry as referenced. Put inserts
+ * or replaces the entry of a key (evicting if need be) and returns the status.
+ * Search, delete and iterators can also be used, while insert() and emplace() are
+ * rejected, since they do not evict.
+ */
+flat_hashtable_t *ht_flat_cache_create(size_t max_entries, size_t entry_sz, size_t key_sz, int *error_code);
+flat_hashtable_t *ht_flat_cache_create_bytes(size_t max_bytes, size_t entry_sz, size_t key_sz, int *error_code);
+void *ht_flat_cache_get(flat_hashtable_t *hashtable, const void *key);
+int ht_flat_cache_put(flat_hashtable_t *hashtable, const void *key, const void *entry);
+
+/* ------------------------ Sets ------------------------ */
+
+/* **** ht_flat_set_create ****
+ * @ Input arguments:
+ *        - size_t hashtable_size      : The initial hashtable size
+ *        - size_t key_sz              : The size of the key
+ *        - int error_code             : The error code, in case of failure
+ * @ Return value:
+ *        - flat_hashtable_t *hashtable     : The hashtable structure manager
+ * @ Description:
+ *
+ * Creates a hashtable that holds only keys (no payload), so each slot is
+ * exactly the size of the key.
+ *
+ * Contains returns 1 if the key exists, add returns 1 if the key was inserted
+ * and 0 if it already existed (error code should be checked for rehashing
+ * failure) and remove has the same returns as delete().
+ * Iterators return the key reference or NULL at the end of the table.
+ */
+flat_hashtable_t *ht_flat_set_create(size_t hashtable_sz, size_t key_sz, int *error_code);
+int ht_flat_set_contains(flat_hashtable_t *hashtable, const void *key);
+int ht_flat_set_add(flat_hashtable_t *hashtable, const void *key, int *error_code);
+int ht_flat_set_remove(flat_hashtable_t *hashtable, const void *key);
+const void *ht_flat_set_start_it(flat_hashtable_t *hashtable);
+const void *ht_flat_set_next_it(flat_hashtable_t *hashtable);
+
+/* ------------------------ Capacity ------------------------ */
+
+/* **** ht_flat_reserve/ht_flat_shrink_to_fit ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *hashtable : The hashtable structure manager
+ *        - size_t entries              : The number of entries to hold
+ * @ Return value:
+ *        - int error_code              : The error code, in case of failure
+ * @ Description:
+ *
+ * Reserve grows the table (with a single resize) so that the given number of entries
+ * can be inserted without any rehashing. Shrink to fit resizes the table to the smallest
+ * capacity that holds the current entries (also clearing the tombstones). The creation size is also interpreted
+ * as the number of expected entries.
+ *
+ * Bounded caches have a fixed capacity and return HASH_WRONG_ARGUMENT.
+ */
+int ht_flat_reserve(flat_hashtable_t *hashtable, size_t entries);
+int ht_flat_shrink_to_fit(flat_hashtable_t *hashtable);
+
+/* **** ht_flat_reseed ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *hashtable : The hashtable structure manager
+ *        - uint64_t seed               : The new seed of the hashers
+ * @ Return value:
+ *        - int error_code              : The error code, in case of failure
+ * @ Description:
+ *
+ * Every table hashes its keys with its own random seed, so different tables have
+ * different layouts. Reseed sets the seed explicitly (i.e for reproducible layouts)
+ * and rehashes the table in place.
+ */
+int ht_flat_reseed(flat_hashtable_t *hashtable, uint64_t seed);
+
 /* ------------------------ Utilities ------------------------ */
 
 size_t ht_flat_get_entries(flat_hashtable_t *hashtable);
@@ -189,6 +434,33 @@ size_t ht_flat_get_capacity(flat_hashtable_t *hashtable);
 double ht_flat_get_load_factor(flat_hashtable_t *hashtable);
 void ht_flat_print_mem_usage(flat_hashtable_t *hashtable);
 
+/* **** ht_flat_probe_stats ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *hashtable : The hashtable structure manager
+ *        - ht_probe_stats_t *stats     : Filled with the statistics of the table
+ * @ Return value:
+ *        - int error_code              : The error code, in case of failure
+ * @ Description:
+ *
+ * Probe length and clustering statistics (see ht_probe_stats_t), so a degraded table can
+ * be detected and fixed with a rehash (reseed or shrink to fit to clear the tombstones).
+ * Every resident key is rehashed, so the call is linear on the capacity of the table.
+ */
+int ht_flat_probe_stats(flat_hashtable_t *hashtable, ht_probe_stats_t *stats);
+
+/* **** ht_flat_get_stats ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *hashtable : The hashtable structure manager
+ *        - ht_op_stats_t *stats        : Filled with the operation counters of the table
+ * @ Return value:
+ *        - int error_code              : The error code, in case of failure
+ * @ Description:
+ *
+ * Snapshot of the operation counters (see ht_op_stats_t). The counters are kept only when
+ * the library is built with HT_STATS, otherwise the snapshot is all zeros.
+ */
+int ht_flat_get_stats(flat_hashtable_t *hashtable, ht_op_stats_t *stats);
+
 /* ------------------------ Iterators ------------------------ */
 
 /* Given the specified hashtable start/end iterator routines
@@ -209,4 +481,17 @@ flat_hashtable_tuple_t ht_flat_next_it(flat_hashtable_t *hashtable);
 flat_hashtable_tuple_t ht_flat_prev_it(flat_hashtable_t *hashtable);
 flat_hashtable_tuple_t ht_flat_end_it(flat_hashtable_t *hashtable);
 
+/* **** ht_flat_erase_it ****
+ * @ Input arguments:
+ *        - flat_hashtable_t *hashtable : The hashtable structure manager
+ * @ Return value:
+ *        - int error_code              : 0 for success or HASH_ENTRY_NOT_EXISTS
+ * @ Description:
+ *
+ * Erases the element last returned by the iterator in O(1), without re-hashing
+ * or probing. The iterator stays valid, so next/prev can be called afterwards. Shrinking
+ * is postponed until the next delete.
+ */
+int ht_flat_erase_it(flat_hashtable_t *hashtable);
+
 #endif   // __FLAT_SPARSE_HASHTABLE_H //
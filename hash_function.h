@@ -194,9 +194,11 @@ static inline uint32_t fmix32(uint32_t h)
  * @ Description:
  *
  * Supporting function, mixes up the bits of a 64-bit number.
+ * The seeded version mixes the seed into the number first.
  */
-static inline uint64_t fmix64(uint64_t k)
+static inline uint64_t fmix64_seeded(uint64_t k, uint64_t seed)
 {
+    k ^= seed;
     k ^= k >> 33;
     k *= 0xff51afd7ed558ccd;
     k ^= k >> 33;
@@ -206,6 +208,11 @@ static inline uint64_t fmix64(uint64_t k)
     return k;
 }
 
+static inline uint64_t fmix64(uint64_t k)
+{
+    return fmix64_seeded(k, 0);
+}
+
 /* **** ShiftMix ****
  * @ Input arguments:
  *        - uint64_t h   : Number to be mixed
@@ -821,6 +828,7 @@ static inline uint32_t hash_thomas_wang_integer(uint32_t key)
  *
  * A simple hash function for integers.
  * Works well on most cases, given a good hashtable size.
+ * The seeded version mixes the seed into the key first.
  */
 static inline uint32_t hash_32shift(uint32_t key)
 {
@@ -843,9 +851,11 @@ static inline uint32_t hash_32shift(uint32_t key)
  *
  * A simple hash function for integers.
  * Works well on most cases, given a good hashtable size.
+ * The seeded version mixes the seed into the key first.
  */
-static inline uint32_t hash_32simp(uint32_t key)
+static inline uint32_t hash_32simp_seeded(uint32_t key, uint64_t seed)
 {
+    key ^= (uint32_t)(seed ^ (seed >> 32));
     key = ((key >> 16) ^ key) * 0x45d9f3b;
     key = ((key >> 16) ^ key) * 0x45d9f3b;
     key = (key >> 16) ^ key;
@@ -853,6 +863,11 @@ static inline uint32_t hash_32simp(uint32_t key)
     return key;
 }
 
+static inline uint32_t hash_32simp(uint32_t key)
+{
+    return hash_32simp_seeded(key, 0);
+}
+
 /********************************** GENERIC HASH FUNCTIONS **********************************/
 
 /* **** hash_murmur3_32 ****
@@ -991,11 +1006,11 @@ static inline uint64_t hash_MurmurHash64A(const void *key, size_t len, size_t se
  * @ Description:
  *
  * A hash function that employs the MurmurOAAT64 hash function.
- *
+ * The seeded version starts from a seed dependent state.
  */
-static inline uint64_t hash_MurmurOAAT64(const void *key, size_t len)
+static inline uint64_t hash_MurmurOAAT64_seeded(const void *key, size_t len, uint64_t seed)
 {
-    uint64_t hash = 525201411107845655;
+    uint64_t hash = 525201411107845655 ^ seed;
     size_t i = 0;
     unsigned const char *us = (unsigned const char *)key;
 
@@ -1010,6 +1025,11 @@ static inline uint64_t hash_MurmurOAAT64(const void *key, size_t len)
     return hash;
 }
 
+static inline uint64_t hash_MurmurOAAT64(const void *key, size_t len)
+{
+    return hash_MurmurOAAT64_seeded(key, len, 0);
+}
+
 /* **** hash_FNV1a ****
  * @ Input arguments:
  *        - void *key             : The key to be hashed
@@ -1331,6 +1351,142 @@ static inline uint64_t hash_CityHash64WithSeed(const char *s, size_t len, uint64
     return hash_CityHash64WithSeeds(s, len, k2, seed);
 }
 
+/* **** wymum ****
+ * @ Input arguments:
+ *        - uint64_t *a  : First factor, low 64 bits of the product on return
+ *        - uint64_t *b  : Second factor, high 64 bits of the product on return
+ * @ Description:
+ *
+ * Supporting function, full 64x64 -> 128-bit multiplication used by wyhash.
+ */
+static inline void wymum(uint64_t *a, uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 wy_uint128;
+    wy_uint128 r = (wy_uint128)*a * *b;
+
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32);
+    uint64_t lo = t + (rm1 << 32), hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl);
+
+    *a = lo;
+    *b = hi + (lo < t);
+#endif
+}
+
+/* **** wymix ****
+ * @ Input arguments:
+ *        - uint64_t a   : First number
+ *        - uint64_t b   : Second number
+ * @ Return value:
+ *        - uint64_t ret : Both halves of the 128-bit product folded together
+ */
+static inline uint64_t wymix(uint64_t a, uint64_t b)
+{
+    wymum(&a, &b);
+    return a ^ b;
+}
+
+/* Unaligned reads of 8, 4 and 1-3 bytes */
+static inline uint64_t wyr8(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t wyr4(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t wyr3(const uint8_t *p, size_t k)
+{
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+/* **** hash_wyhash ****
+ * @ Input arguments:
+ *        - const void *key : The key to be hashed
+ *        - size_t len      : The length of the key
+ *        - uint64_t seed   : The seed
+ * @ Return value:
+ *        - uint64_t hash   : Resulting hash
+ * @ Description:
+ *
+ * A hash function that follows the design of wyhash (final version). Keys up to 16
+ * bytes are hashed with a couple of overlapping reads and a single multiplication,
+ * while longer keys are consumed 16 (or 48) bytes at a time. The default hasher for
+ * variable length and large fixed size keys.
+ */
+static inline uint64_t hash_wyhash(const void *key, size_t len, uint64_t seed)
+{
+    static const uint64_t wyp[4] = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+    const uint8_t *p = (const uint8_t *)key;
+    uint64_t a, b;
+
+    seed ^= wymix(seed ^ wyp[0], wyp[1]);
+
+    if(len <= 16)
+    {
+        if(len >= 4)
+        {
+            a = (wyr4(p) << 32) | wyr4(p + ((len >> 3) << 2));
+            b = (wyr4(p + len - 4) << 32) | wyr4(p + len - 4 - ((len >> 3) << 2));
+        }
+        else if(len > 0)
+        {
+            a = wyr3(p, len);
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t i = len;
+
+        if(i > 48)
+        {
+            uint64_t see1 = seed, see2 = seed;
+
+            do
+            {
+                seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+                see1 = wymix(wyr8(p + 16) ^ wyp[2], wyr8(p + 24) ^ see1);
+                see2 = wymix(wyr8(p + 32) ^ wyp[3], wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while(i > 48);
+
+            seed ^= see1 ^ see2;
+        }
+
+        while(i > 16)
+        {
+            seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = wyr8(p + i - 16);
+        b = wyr8(p + i - 8);
+    }
+
+    a ^= wyp[1];
+    b ^= seed;
+    wymum(&a, &b);
+
+    return wymix(a ^ wyp[0] ^ len, b ^ wyp[1]);
+}
+
 /* **** siphash24 ****
  * @ Input arguments:
  *        - void *src             : The src(key) to be hashed
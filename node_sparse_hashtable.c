@@ -15,17 +15,40 @@
 
 /******************************************** Private Structures/Defines ********************************************/
 
+/* Short keys are kept inside the slot (with their length), so comparisons
+ * for these do not have to dereference the key. Longer keys spill to the
+ * key reference and use the comparator of the user. */
+#define NODE_INLINE_KEYS
+#define NODE_INLINE_KEY_SZ 15
+#define NODE_KEY_SPILLED   0xff
+
+/* Key length reported in full hash mode - Keys are never inlined */
+#define NODE_KEY_NO_LEN ((size_t)-1)
+
+/* Map slots are 32 bytes, so with this allignment a slot never crosses a cache line */
+#define NODE_TABLE_ALLIGN 64
+
 /* **** node_pair_t ****
  *
  * A bucket in the hashtable, used only for bookeeping
- * and organization purposes.
+ * and organization purposes. The entry reference is last, so
+ * sets use only the slot up to it (NODE_SET_SLOT_SZ bytes).
  */
 typedef struct node_hashtable_pair
 {
     void *key;
+
+    /* Inline copy of the key - Tag holds the length or NODE_KEY_SPILLED
+     * (Spilled keys keep their length here instead) */
+    char key_data[NODE_INLINE_KEY_SZ];
+    uint8_t key_tag;
+
     void *entry;
 } node_pair_t;
 
+/* Slot size of sets - Payload-free, so without the entry reference */
+#define NODE_SET_SLOT_SZ offsetof(node_pair_t, entry)
+
 /* **** hashtable_struct ****
  *
  * The manager structure for a Swiss Hashtable. The struct is
@@ -39,8 +62,9 @@ struct node_hashtable_struct
     size_t hashtable_sz;
     size_t group_num;
 
-    /* The table that holds entries+keys */
-    node_pair_t *table;
+    /* The table that holds entries+keys - Slots are accessed by size (shorter for sets) */
+    char *table;
+    size_t slot_sz;
 
     /* The bitmap used for quick access */
     uint8_t *bitmap;
@@ -54,10 +78,19 @@ struct node_hashtable_struct
     /* Iterator sub-structure */
     hashtable_iter_t iterator;
 
-    /* Function pointers for the main operations */
+    /* Function pointers for the main operations (Sets use only the key destructor) */
     void (*destruct)(void *entry, void *key);
+    void (*destruct_key)(void *key);
     int (*comp)(const void *key1, const void *key2);
     size_t (*hash)(const void *key);
+
+    /* Full hash mode - The hash of the user is used as is (NULL otherwise) */
+    uint64_t (*hash_full)(const void *key);
+
+#ifdef HT_STATS
+    /* Operation counters */
+    ht_op_stats_t stats;
+#endif
 };
 
 /* Probing technique - Either one or the other */
@@ -66,30 +99,46 @@ struct node_hashtable_struct
 
 /* Hash function related - If security is needed use Crypto */
 #define USE_DEFAULT_HASH
+//#define USE_CITY_HASH
 //#define USE_CRYPTO_HASH
 
 /**************************** Private function Prototypes ******************************/
 
 /* Utility sub-routines */
 static inline size_t _ht_node_hasher(const char *key, size_t hash_sz, uint64_t seed);
+static inline size_t _ht_node_hash_key(node_hashtable_t *hashtable, const void *key, size_t *key_len);
+static inline int _ht_node_probe_valid(node_hashtable_t *hashtable, ht_probe_t probe);
+static inline int _ht_node_comp_slot(node_hashtable_t *hashtable, const node_pair_t *slot, const void *key, size_t key_len, int span);
+static inline node_pair_t *_ht_node_slot(node_hashtable_t *hashtable, size_t idx);
+static inline void *_ht_node_entry(node_hashtable_t *hashtable, const node_pair_t *slot);
+static inline void _ht_node_set_slot(node_hashtable_t *hashtable, node_pair_t *slot, void *key, void *entry, size_t key_len);
+static inline size_t _ht_node_find_free(node_hashtable_t *hashtable, size_t hash);
+static inline void _ht_node_destruct(node_hashtable_t *hashtable, node_pair_t *slot);
+static void _ht_node_destruct_none(void *entry, void *key);
 
 /* Sub-routine for iteration */
 static int _ht_iter_valid_group(node_hashtable_t *hashtable, size_t *start_group, uint16_t *final_group_mask, short int direction);
 
 /* Sub-routines for the main operations of the hashtable */
-static void *_ht_node_search(node_hashtable_t *hashtable, const void *key);
-static void *_ht_node_insert(node_hashtable_t *hashtable, void *key, void *entry, char flag);
-static int _ht_node_delete(node_hashtable_t *hashtable, const void *key);
+static inline size_t _ht_node_find(node_hashtable_t *hashtable, const void *key, size_t key_len, size_t hash, int span);
+static void *_ht_node_search(node_hashtable_t *hashtable, const void *key, size_t key_len, size_t hash);
+static inline size_t _ht_node_find_or_free(node_hashtable_t *hashtable, const void *key, size_t key_len, size_t hash, int *found);
+static node_pair_t *_ht_node_find_or_insert(node_hashtable_t *hashtable, void *key, void *entry, size_t key_len, size_t hash, int *inserted, int *error_code);
+static int _ht_node_delete(node_hashtable_t *hashtable, const void *key, size_t key_len, size_t hash, int span);
 static int _ht_node_resize(node_hashtable_t *hashtable, size_t new_sz);
+static node_hashtable_t *_ht_node_create(size_t hashtable_sz, size_t slot_sz, int (*comp)(const void *, const void *), size_t (*hash)(const void *), int *error_code);
 
 /************************************ Internal Routines ************************************/
 
 /* Hasher wrapper used for the hashing of the keys */
 static inline size_t _ht_node_hasher(const char *key, size_t hash_sz, uint64_t seed)
 {
-#if !defined(USE_CRYPTO_HASH)
-    /* Default hasher */
+#if defined(USE_CITY_HASH)
+    /* Previous default hasher */
     return hash_CityHash64WithSeed(key, hash_sz, seed);
+#elif !defined(USE_CRYPTO_HASH)
+    /* Default hasher */
+    return hash_wyhash(key, hash_sz, seed);
 #else
     uint64_t sd[2] = {seed, seed};
 
@@ -98,6 +147,124 @@ static inline size_t _ht_node_hasher(const char *key, size_t hash_sz, uint64_t s
 #endif
 }
 
+/* Hashes a key with the mode of the table - Also returns the length of the key */
+static inline size_t _ht_node_hash_key(node_hashtable_t *hashtable, const void *key, size_t *key_len)
+{
+    if(hashtable->hash_full)
+    {
+        *key_len = NODE_KEY_NO_LEN;
+        return hashtable->hash_full(key);
+    }
+
+    *key_len = hashtable->hash(key);
+
+    return _ht_node_hasher(key, *key_len, hashtable->hash_seed);
+}
+
+/* Checks if a prepared hash is valid for the table - The modes must match, the seeds only matter without a full hash */
+static inline int _ht_node_probe_valid(node_hashtable_t *hashtable, ht_probe_t probe)
+{
+    if(hashtable->hash_full)
+        return probe.full_hash;
+
+    return !probe.full_hash && probe.seed == hashtable->hash_seed;
+}
+
+/* Compares the key of a slot with a given key (of key_len bytes) - Spans are compared bytewise */
+static inline int _ht_node_comp_slot(node_hashtable_t *hashtable, const node_pair_t *slot, const void *key, size_t key_len, int span)
+{
+    size_t slot_len;
+
+#ifdef NODE_INLINE_KEYS
+    /* If either of the keys is short, lengths and the inline copy decide */
+    if(slot->key_tag != NODE_KEY_SPILLED || key_len <= NODE_INLINE_KEY_SZ)
+        return (slot->key_tag == key_len) && !memcmp(slot->key_data, key, key_len);
+#endif
+
+    /* Spilled keys of another length never match */
+    memcpy(&slot_len, slot->key_data, sizeof(size_t));
+
+    if(slot_len != key_len)
+        return 0;
+
+    return (span) ? !memcmp(slot->key, key, key_len) : hashtable->comp(slot->key, key);
+}
+
+/* Slot of an index */
+static inline node_pair_t *_ht_node_slot(node_hashtable_t *hashtable, size_t idx)
+{
+    return (node_pair_t *)&hashtable->table[idx * hashtable->slot_sz];
+}
+
+/* Entry of a slot - The key reference doubles as the entry of sets, so searches return non NULL */
+static inline void *_ht_node_entry(node_hashtable_t *hashtable, const node_pair_t *slot)
+{
+    return (hashtable->slot_sz == NODE_SET_SLOT_SZ) ? slot->key : slot->entry;
+}
+
+/* Fills a slot with the references and the inline copy of the key (if short) */
+static inline void _ht_node_set_slot(node_hashtable_t *hashtable, node_pair_t *slot, void *key, void *entry, size_t key_len)
+{
+    slot->key = key;
+    if(hashtable->slot_sz != NODE_SET_SLOT_SZ)
+        slot->entry = entry;
+
+    slot->key_tag = NODE_KEY_SPILLED;
+    memcpy(slot->key_data, &key_len, sizeof(size_t));
+
+#ifdef NODE_INLINE_KEYS
+    if(key_len <= NODE_INLINE_KEY_SZ)
+    {
+        memcpy(slot->key_data, key, key_len);
+        slot->key_tag = key_len;
+    }
+#endif
+}
+
+/* Calls the destructor of the user on a slot (Sets only own the key) */
+static inline void _ht_node_destruct(node_hashtable_t *hashtable, node_pair_t *slot)
+{
+    if(hashtable->destruct)
+        hashtable->destruct(_ht_node_entry(hashtable, slot), slot->key);
+    else
+        hashtable->destruct_key(slot->key);
+}
+
+/* Destructor of the non owning (shallow) clones */
+static void _ht_node_destruct_none(void *entry, void *key)
+{
+}
+
+/* Finds the first empty or deleted position for the given hash */
+static inline size_t _ht_node_find_free(node_hashtable_t *hashtable, size_t hash)
+{
+    const size_t group_mask = hashtable->group_num - 1; /* Now this is a bitmask */
+    size_t group_idx = (hash >> GROUP_H1_SHIFT) & group_mask;
+#ifndef SPARSE_LIN_PROBE
+    size_t probe_step = 1;
+#endif
+
+    while(1)
+    {
+        /* Create the new masks */
+        uint8_t *bitmap_pos = &hashtable->bitmap[group_idx * GROUP_SIZE];
+        uint16_t empty_or_del_mask = _ht_and_mask(bitmap_pos, HIGH_BIT_MASK);
+
+        /* Found empty spot */
+        if(empty_or_del_mask)
+            return (group_idx * GROUP_SIZE) + _get_first_set_bit_pos(empty_or_del_mask);
+
+/* Probe */
+#ifdef SPARSE_LIN_PROBE
+        group_idx = (group_idx + 1) & group_mask;
+#else
+        group_idx = (group_idx + probe_step) & group_mask;
+#endif
+    }
+
+    return 0; /* Suppress compiler warnings */
+}
+
 /* Finds the next valid group in the hashtable - Forward or backward (1 or -1) */
 static int _ht_iter_valid_group(node_hashtable_t *hashtable, size_t *start_group, uint16_t *final_group_mask, short int direction)
 {
@@ -121,14 +288,12 @@ static int _ht_iter_valid_group(node_hashtable_t *hashtable, size_t *start_group
     return ITER_NOT_VALID;
 }
 
-/* The main lookup sub-routine */
-static void *_ht_node_search(node_hashtable_t *hashtable, const void *key)
+/* The main lookup sub-routine - Returns the slot index of the key or SLOT_NOT_FOUND */
+static inline size_t _ht_node_find(node_hashtable_t *hashtable, const void *key, size_t key_len, size_t hash, int span)
 {
     const size_t group_mask = hashtable->group_num - 1; /* Now this becomes a mask */
-    node_pair_t *table = hashtable->table;
 
-    /* Find the hash and the metadata for the given key */
-    const size_t hash = _ht_node_hasher(key, hashtable->hash(key), hashtable->hash_seed);
+    /* Metadata for the given key */
     const uint8_t bitmap_ctrl = hash & GROUP_H2_MASK;
 
     /* Simple power of 2 modding to find the group index */
@@ -137,11 +302,15 @@ static void *_ht_node_search(node_hashtable_t *hashtable, const void *key)
     size_t probe_step = 1;
 #endif
 
+    HT_STAT_INC(hashtable, searches);
+
     while(1)
     {
         /* Create an index for the matches */
         size_t i = group_idx * GROUP_SIZE;
 
+        HT_STAT_INC(hashtable, groups_probed);
+
         /* Create the new masks */
         uint8_t *bitmap_pos = &hashtable->bitmap[i];
         uint16_t eq_mask = _ht_eq_mask(bitmap_pos, bitmap_ctrl);
@@ -153,8 +322,11 @@ static void *_ht_node_search(node_hashtable_t *hashtable, const void *key)
             size_t pos = _get_first_set_bit_pos(eq_mask);
 
             /* Found an empty position */
-            if(HT_LIKELY(hashtable->comp(table[i + pos].key, key)))
-                return table[i + pos].entry;
+            if(HT_LIKELY(_ht_node_comp_slot(hashtable, _ht_node_slot(hashtable, i + pos), key, key_len, span)))
+            {
+                HT_STAT_INC(hashtable, hits);
+                return i + pos;
+            }
 
             /* Unset this entry */
             eq_mask ^= 1 << pos;
@@ -162,7 +334,10 @@ static void *_ht_node_search(node_hashtable_t *hashtable, const void *key)
 
         /* Search stop condition */
         if(HT_LIKELY(empty_mask))
-            return NULL;
+        {
+            HT_STAT_INC(hashtable, misses);
+            return SLOT_NOT_FOUND;
+        }
 
 /* Probe */
 #ifdef SPARSE_LIN_PROBE
@@ -172,51 +347,71 @@ static void *_ht_node_search(node_hashtable_t *hashtable, const void *key)
 #endif
     }
 
-    return NULL; /* Suppress compiler warnings */
+    return SLOT_NOT_FOUND; /* Suppress compiler warnings */
 }
 
-/* The main insertion sub-routine. Performs different kinds of insertion based on action */
-static void *_ht_node_insert(node_hashtable_t *hashtable, void *key, void *entry, char flag)
+/* The main lookup sub-routine */
+static void *_ht_node_search(node_hashtable_t *hashtable, const void *key, size_t key_len, size_t hash)
 {
-    /* Resizing = NO_SEARCH | Insert = SEARCH_NO_REPLACE */
-    if(flag != NO_SEARCH)
-    {
-        void *ret = _ht_node_search(hashtable, key);
-        if(ret)
-            return ret;
-    }
+    const size_t idx = _ht_node_find(hashtable, key, key_len, hash, 0);
 
-    /* Restart the search - Constants */
-    const size_t group_mask = hashtable->group_num - 1; /* Now this is a bitmask */
-    const size_t hash = _ht_node_hasher(key, hashtable->hash(key), hashtable->hash_seed);
+    return (idx == SLOT_NOT_FOUND) ? NULL : _ht_node_entry(hashtable, _ht_node_slot(hashtable, idx));
+}
+
+/* Single probe lookup - Returns the slot of the key or (if it does not exist) the first free slot seen */
+static inline size_t _ht_node_find_or_free(node_hashtable_t *hashtable, const void *key, size_t key_len, size_t hash, int *found)
+{
+    const size_t group_mask = hashtable->group_num - 1; /* Now this becomes a mask */
+    const uint8_t bitmap_ctrl = hash & GROUP_H2_MASK;
 
-    /* Initial conditions */
-    node_pair_t *table = hashtable->table;
+    /* Starting group index */
     size_t group_idx = (hash >> GROUP_H1_SHIFT) & group_mask;
+    size_t free_idx = SLOT_NOT_FOUND;
 #ifndef SPARSE_LIN_PROBE
     size_t probe_step = 1;
 #endif
 
     while(1)
     {
+        size_t i = group_idx * GROUP_SIZE;
+
+        HT_STAT_INC(hashtable, groups_probed);
+
         /* Create the new masks */
-        uint8_t *bitmap_pos = &hashtable->bitmap[group_idx * GROUP_SIZE];
-        uint16_t empty_or_del_mask = _ht_and_mask(bitmap_pos, HIGH_BIT_MASK);
+        uint8_t *bitmap_pos = &hashtable->bitmap[i];
+        uint16_t eq_mask = _ht_eq_mask(bitmap_pos, bitmap_ctrl);
+        uint16_t empty_mask = _ht_eq_mask(bitmap_pos, ENTRY_EMPTY);
 
-        /* Found empty spot */
-        if(empty_or_del_mask)
+        /* As long as there are matches */
+        while(eq_mask)
         {
-            size_t pos = (group_idx * GROUP_SIZE) + _get_first_set_bit_pos(empty_or_del_mask);
+            size_t pos = _get_first_set_bit_pos(eq_mask);
 
-            /* Insertion in the hashtable */
-            table[pos].key = key;
-            table[pos].entry = entry;
-            hashtable->bitmap[pos] = hash & (GROUP_H2_MASK);
+            if(HT_LIKELY(_ht_node_comp_slot(hashtable, _ht_node_slot(hashtable, i + pos), key, key_len, 0)))
+            {
+                HT_STAT_INC(hashtable, duplicates);
+                *found = 1;
+                return i + pos;
+            }
 
-            /* Fix the bitmap and toggle the first bit afterwards */
-            hashtable->entries++;
+            /* Unset this entry */
+            eq_mask ^= 1 << pos;
+        }
 
-            return NULL;
+        /* Remember the first empty or deleted slot of the sequence */
+        if(free_idx == SLOT_NOT_FOUND)
+        {
+            uint16_t empty_or_del_mask = _ht_and_mask(bitmap_pos, HIGH_BIT_MASK);
+
+            if(empty_or_del_mask)
+                free_idx = i + _get_first_set_bit_pos(empty_or_del_mask);
+        }
+
+        /* Search stop condition - There is always a free slot by now */
+        if(HT_LIKELY(empty_mask))
+        {
+            *found = 0;
+            return free_idx;
         }
 
 /* Probe */
@@ -227,19 +422,54 @@ static void *_ht_node_insert(node_hashtable_t *hashtable, void *key, void *entry
 #endif
     }
 
-    return NULL; /* Suppress compiler warnings */
+    return SLOT_NOT_FOUND; /* Suppress compiler warnings */
+}
+
+/* Single pass insertion sub-routine. Returns the slot of the key (existing or new) */
+static node_pair_t *_ht_node_find_or_insert(node_hashtable_t *hashtable, void *key, void *entry, size_t key_len, size_t hash, int *inserted, int *error_code)
+{
+    int found;
+    size_t idx = _ht_node_find_or_free(hashtable, key, key_len, hash, &found);
+
+    /* Key exists */
+    if(found)
+    {
+        *inserted = 0;
+        return _ht_node_slot(hashtable, idx);
+    }
+
+    /* Grow before placing, so the returned slot stays valid - Doubling is the resizing policy */
+    if(hashtable->entries >= UPPER_LIMIT(hashtable->hashtable_sz))
+    {
+        *error_code = _ht_node_resize(hashtable, hashtable->hashtable_sz << 1);
+
+        if(*error_code != HASH_OK)
+        {
+            *inserted = 0;
+            return NULL;
+        }
+
+        idx = _ht_node_find_free(hashtable, hash);
+    }
+
+    /* Insertion in the hashtable */
+    _ht_node_set_slot(hashtable, _ht_node_slot(hashtable, idx), key, entry, key_len);
+    hashtable->bitmap[idx] = hash & (GROUP_H2_MASK);
+    hashtable->entries++;
+    HT_STAT_INC(hashtable, inserts);
+    *inserted = 1;
+
+    return _ht_node_slot(hashtable, idx);
 }
 
 /* The main delete sub-routine */
-static int _ht_node_delete(node_hashtable_t *hashtable, const void *key)
+static int _ht_node_delete(node_hashtable_t *hashtable, const void *key, size_t key_len, size_t hash, int span)
 {
     /* Constants */
     const size_t group_mask = hashtable->group_num - 1; /* Now this becomes a mask */
-    const size_t hash = _ht_node_hasher(key, hashtable->hash(key), hashtable->hash_seed);
     const uint8_t bitmap_ctrl = hash & GROUP_H2_MASK;
 
     /* Starting group index */
-    node_pair_t *table = hashtable->table;
     size_t group_idx = (hash >> GROUP_H1_SHIFT) & group_mask;
 #ifndef SPARSE_LIN_PROBE
     size_t probe_step = 1;
@@ -251,6 +481,8 @@ static int _ht_node_delete(node_hashtable_t *hashtable, const void *key)
         /* Index for the <key, entries> table */
         size_t i = group_idx * GROUP_SIZE;
 
+        HT_STAT_INC(hashtable, groups_probed);
+
         /* Create the new masks */
         uint8_t *bitmap_pos = &hashtable->bitmap[i];
         uint16_t eq_mask = _ht_eq_mask(bitmap_pos, bitmap_ctrl);
@@ -261,12 +493,13 @@ static int _ht_node_delete(node_hashtable_t *hashtable, const void *key)
             /* Found an empty position */
             size_t pos = _get_first_set_bit_pos(eq_mask);
 
-            if(hashtable->comp(table[i + pos].key, key))
+            if(_ht_node_comp_slot(hashtable, _ht_node_slot(hashtable, i + pos), key, key_len, span))
             {
                 /* Put a tombstone only if there no empty entries in the group */
                 hashtable->bitmap[i + pos] = (empty_mask) ? ENTRY_EMPTY : ENTRY_DELETED;
-                hashtable->destruct(table[i + pos].entry, table[i + pos].key);
+                _ht_node_destruct(hashtable, _ht_node_slot(hashtable, i + pos));
                 hashtable->entries--;
+                HT_STAT_INC(hashtable, deletes);
                 return HASH_OK;
             }
 
@@ -292,9 +525,13 @@ static int _ht_node_resize(node_hashtable_t *hashtable, size_t new_sz)
 {
     /* Constants */
     const size_t num_of_groups = hashtable->hashtable_sz >> GROUP_SIZE_SHIFT;
+#ifdef HT_STATS
+    const uint64_t start_ns = _ht_stat_now_ns();
+#endif
 
     /* New tables */
-    node_pair_t *new_table = calloc(new_sz, sizeof(node_pair_t));
+    const size_t slot_sz = hashtable->slot_sz;
+    char *new_table = aligned_alloc(NODE_TABLE_ALLIGN, new_sz * slot_sz);
     uint8_t *new_bitmap = aligned_alloc(BITMAP_FORCE_ALLIGN, new_sz * sizeof(uint8_t));
 
     if(!new_table || !new_bitmap)
@@ -307,8 +544,13 @@ static int _ht_node_resize(node_hashtable_t *hashtable, size_t new_sz)
     /* Set every entry as empty in the new bitmap */
     memset(new_bitmap, ENTRY_EMPTY, new_sz * sizeof(uint8_t));
 
+    /* Same capacity rehashes only clear the tombstones */
+    HT_STAT_ADD(hashtable, resizes_up, new_sz > hashtable->hashtable_sz);
+    HT_STAT_ADD(hashtable, resizes_down, new_sz < hashtable->hashtable_sz);
+    HT_STAT_ADD(hashtable, rehashes, new_sz == hashtable->hashtable_sz);
+
     /* Setup variables - Old table parameters */
-    node_pair_t *old_table = hashtable->table;
+    char *old_table = hashtable->table;
     uint8_t *old_bitmap = hashtable->bitmap;
 
     /* Update the new_table parameters */
@@ -316,6 +558,7 @@ static int _ht_node_resize(node_hashtable_t *hashtable, size_t new_sz)
     hashtable->table = new_table;
     hashtable->hashtable_sz = new_sz;
     hashtable->iterator.iter_state = ITER_NOT_VALID;
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
     hashtable->group_num = new_sz >> GROUP_SIZE_SHIFT;
     hashtable->entries = 0;
 
@@ -334,10 +577,23 @@ static int _ht_node_resize(node_hashtable_t *hashtable, size_t new_sz)
         while(valid_entries_mask)
         {
             size_t pos = _get_first_set_bit_pos(valid_entries_mask);
-            size_t tmp = cur_idx + pos;
+            node_pair_t *slot = (node_pair_t *)&old_table[(cur_idx + pos) * slot_sz];
+            size_t hash, new_pos;
 
-            /* Insert safely - Each key is unique */
-            _ht_node_insert(hashtable, old_table[tmp].key, old_table[tmp].entry, NO_SEARCH);
+            /* Short keys are rehashed from the slot itself */
+            if(slot->key_tag != NODE_KEY_SPILLED)
+                hash = _ht_node_hasher(slot->key_data, slot->key_tag, hashtable->hash_seed);
+            else
+            {
+                size_t key_len;
+                hash = _ht_node_hash_key(hashtable, slot->key, &key_len);
+            }
+
+            /* Insert safely - Each key is unique so the slot is moved as is */
+            new_pos = _ht_node_find_free(hashtable, hash);
+            memcpy(_ht_node_slot(hashtable, new_pos), slot, slot_sz);
+            new_bitmap[new_pos] = hash & (GROUP_H2_MASK);
+            hashtable->entries++;
 
             /* Unset this entry */
             valid_entries_mask ^= 1 << pos;
@@ -348,26 +604,18 @@ static int _ht_node_resize(node_hashtable_t *hashtable, size_t new_sz)
     free(old_bitmap);
     free(old_table);
 
+    HT_STAT_ADD(hashtable, moved, hashtable->entries);
+    HT_STAT_ADD(hashtable, rehash_ns, _ht_stat_now_ns() - start_ns);
+
     return HASH_OK;
 }
 
-/************************************ Main Routines for Node ************************************/
-
-node_hashtable_t *ht_node_create(size_t hashtable_sz,
-                                 int (*comp)(const void *, const void *),
-                                 void (*destruct)(void *, void *),
-                                 size_t (*hash)(const void *), int *error_code)
+/* The main constructor sub-routine. Destructors are set by the callers */
+static node_hashtable_t *_ht_node_create(size_t hashtable_sz, size_t slot_sz, int (*comp)(const void *, const void *), size_t (*hash)(const void *), int *error_code)
 {
     /* Set the error code */
     *error_code = HASH_OK;
 
-    /* Check input by the user - Necessary inputs */
-    if(!hashtable_sz || !comp || !destruct || !hash)
-    {
-        *error_code = HASH_WRONG_ARGUMENT;
-        return NULL;
-    }
-
     /* Fix the size for the hashtable.
      * Minimum is 32 entries (2 groups) since alligned alloc requires multiples of
      * allignment (address sanitizer report ?) of 32. Not much of a difference 32 is a pretty good
@@ -385,7 +633,7 @@ node_hashtable_t *ht_node_create(size_t hashtable_sz,
         return NULL;
     }
 
-    hashtable->table = calloc(hashtable_sz, sizeof(node_pair_t));
+    hashtable->table = aligned_alloc(NODE_TABLE_ALLIGN, hashtable_sz * slot_sz);
     hashtable->bitmap = aligned_alloc(BITMAP_FORCE_ALLIGN, hashtable_sz * sizeof(uint8_t));
 
     /* Final assertions */
@@ -401,20 +649,72 @@ node_hashtable_t *ht_node_create(size_t hashtable_sz,
     /* Initialize the bitmap - Set it to 0xFF everywhere */
     memset(hashtable->bitmap, ENTRY_EMPTY, hashtable_sz * sizeof(uint8_t));
 
-    /* Seeding of the hashtable */
-    srand(time(NULL));
-    hashtable->hash_seed = rand();
+    /* Seeding of the hashtable - Different for every table */
+    hashtable->hash_seed = _ht_generate_seed(hashtable);
 
     /* Main parameters of the hashtable - Initialize all the sizes and the seed */
     hashtable->hashtable_sz = hashtable_sz;
     hashtable->group_num = hashtable_sz >> GROUP_SIZE_SHIFT;
+    hashtable->slot_sz = slot_sz;
     hashtable->entries = 0;
     hashtable->iterator.iter_state = ITER_NOT_VALID;
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
 
     /* Function pointers */
-    hashtable->destruct = destruct;
+    hashtable->destruct = NULL;
+    hashtable->destruct_key = NULL;
     hashtable->comp = comp;
     hashtable->hash = hash;
+    hashtable->hash_full = NULL;
+
+#ifdef HT_STATS
+    memset(&hashtable->stats, 0, sizeof(ht_op_stats_t));
+#endif
+
+    return hashtable;
+}
+
+/************************************ Main Routines for Node ************************************/
+
+node_hashtable_t *ht_node_create(size_t hashtable_sz,
+                                 int (*comp)(const void *, const void *),
+                                 void (*destruct)(void *, void *),
+                                 size_t (*hash)(const void *), int *error_code)
+{
+    /* Check input by the user - Necessary inputs */
+    if(!hashtable_sz || !comp || !destruct || !hash)
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
+    }
+
+    node_hashtable_t *hashtable = _ht_node_create(_get_capacity_for_entries(hashtable_sz), sizeof(node_pair_t), comp, hash, error_code);
+
+    if(hashtable)
+        hashtable->destruct = destruct;
+
+    return hashtable;
+}
+
+node_hashtable_t *ht_node_create_hashed(size_t hashtable_sz,
+                                        int (*comp)(const void *, const void *),
+                                        void (*destruct)(void *, void *),
+                                        uint64_t (*hash_full)(const void *), int *error_code)
+{
+    /* Check input by the user - Necessary inputs */
+    if(!hashtable_sz || !comp || !destruct || !hash_full)
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
+    }
+
+    node_hashtable_t *hashtable = _ht_node_create(_get_capacity_for_entries(hashtable_sz), sizeof(node_pair_t), comp, NULL, error_code);
+
+    if(hashtable)
+    {
+        hashtable->destruct = destruct;
+        hashtable->hash_full = hash_full;
+    }
 
     return hashtable;
 }
@@ -425,13 +725,16 @@ void *ht_node_search(node_hashtable_t *hashtable, const void *key)
     if(HT_LIKELY(!key || !hashtable))
         return NULL;
 
-    return _ht_node_search(hashtable, key);
+    size_t key_len;
+    const size_t hash = _ht_node_hash_key(hashtable, key, &key_len);
+
+    return _ht_node_search(hashtable, key, key_len, hash);
 }
 
 void *ht_node_insert(node_hashtable_t *hashtable, void *key, void *entry, int *error_code)
 {
-    /* Check user input */
-    if(HT_LIKELY(!key || !entry || !hashtable || !error_code))
+    /* Check user input - Sets have no entry (keys are added with set_add) */
+    if(HT_LIKELY(!key || !entry || !hashtable || !error_code || hashtable->slot_sz == NODE_SET_SLOT_SZ))
     {
         *error_code = HASH_WRONG_ARGUMENT;
         return NULL;
@@ -440,16 +743,70 @@ void *ht_node_insert(node_hashtable_t *hashtable, void *key, void *entry, int *e
     /* Set error code */
     *error_code = HASH_OK;
 
-    void *ret = _ht_node_insert(hashtable, key, entry, SEARCH_NO_REPLACE);
+    int inserted;
+    size_t key_len;
+    const size_t hash = _ht_node_hash_key(hashtable, key, &key_len);
+    node_pair_t *slot = _ht_node_find_or_insert(hashtable, key, entry, key_len, hash, &inserted, error_code);
 
-    /* Also check if there is a need for rehashing */
-    if(hashtable->entries > UPPER_LIMIT(hashtable->hashtable_sz))
+    /* Existing entry is returned */
+    return (slot && !inserted) ? _ht_node_entry(hashtable, slot) : NULL;
+}
+
+void *ht_node_emplace(node_hashtable_t *hashtable, void *key, void *entry, int *error_code)
+{
+    /* Check user input - Sets have no entry to swap */
+    if(HT_UNLIKELY(!key || !entry || !hashtable || !error_code || hashtable->slot_sz == NODE_SET_SLOT_SZ))
     {
-        /* Inforn in case of rehashing error - Doubling is the resizing policy */
-        *error_code = _ht_node_resize(hashtable, hashtable->hashtable_sz << 1);
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
     }
 
-    return ret;
+    /* Set error code */
+    *error_code = HASH_OK;
+
+    int inserted;
+    size_t key_len;
+    const size_t hash = _ht_node_hash_key(hashtable, key, &key_len);
+    node_pair_t *slot = _ht_node_find_or_insert(hashtable, key, entry, key_len, hash, &inserted, error_code);
+
+    if(!slot || inserted)
+        return NULL;
+
+    /* Swap the entry in place - The stored key is kept, the old entry is handed back to the user */
+    void *old_entry = slot->entry;
+    slot->entry = entry;
+
+    return old_entry;
+}
+
+void *ht_node_replace(node_hashtable_t *hashtable, void *key, void *entry, int *error_code)
+{
+    /* Check user input - Sets have no entry to swap */
+    if(HT_UNLIKELY(!key || !entry || !hashtable || !error_code || hashtable->slot_sz == NODE_SET_SLOT_SZ))
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
+    }
+
+    size_t key_len;
+    const size_t hash = _ht_node_hash_key(hashtable, key, &key_len);
+    const size_t idx = _ht_node_find(hashtable, key, key_len, hash, 0);
+
+    /* Replace never inserts */
+    if(idx == SLOT_NOT_FOUND)
+    {
+        *error_code = HASH_ENTRY_NOT_EXISTS;
+        return NULL;
+    }
+
+    *error_code = HASH_OK;
+
+    /* Swap the entry in place - The stored key is kept, the old entry is handed back to the user */
+    node_pair_t *slot = _ht_node_slot(hashtable, idx);
+    void *old_entry = slot->entry;
+    slot->entry = entry;
+
+    return old_entry;
 }
 
 int ht_node_delete(node_hashtable_t *hashtable, const void *key)
@@ -460,7 +817,9 @@ int ht_node_delete(node_hashtable_t *hashtable, const void *key)
     if(HT_LIKELY(!key || !hashtable))
         return HASH_WRONG_ARGUMENT;
 
-    ret = _ht_node_delete(hashtable, key);
+    size_t key_len;
+    const size_t hash = _ht_node_hash_key(hashtable, key, &key_len);
+    ret = _ht_node_delete(hashtable, key, key_len, hash, 0);
 
     /* Also check if there is a need for rehashing */
     if((hashtable->entries < LOWER_LIMIT(hashtable->hashtable_sz)) && hashtable->hashtable_sz != (2 * GROUP_SIZE))
@@ -472,40 +831,185 @@ int ht_node_delete(node_hashtable_t *hashtable, const void *key)
     return ret;
 }
 
-void ht_node_free(node_hashtable_t *hashtable)
+void *ht_node_search_span(node_hashtable_t *hashtable, const void *key, size_t key_len)
 {
-    /* Nothing to free, return */
-    if(!hashtable)
-        return;
+    /* Check user input - Spans are hashed by the table, so not in full hash mode */
+    if(HT_UNLIKELY(!key || !hashtable || hashtable->hash_full))
+        return NULL;
 
-    const size_t num_of_groups = hashtable->hashtable_sz >> GROUP_SIZE_SHIFT;
-    node_pair_t *table = hashtable->table;
+    const size_t hash = _ht_node_hasher(key, key_len, hashtable->hash_seed);
+    const size_t idx = _ht_node_find(hashtable, key, key_len, hash, 1);
 
-    /* Iterate over the table */
-    for(size_t i = 0; i < num_of_groups; i++)
-    {
-        /* Find empty_or_deleted -> Invert for the valid entries */
-        size_t cur_idx = i * GROUP_SIZE;
-        uint16_t valid_entries_mask = ~(_ht_and_mask(&hashtable->bitmap[cur_idx], HIGH_BIT_MASK));
+    return (idx == SLOT_NOT_FOUND) ? NULL : _ht_node_entry(hashtable, _ht_node_slot(hashtable, idx));
+}
 
-        /* This iteration step is trivial - No entries in this group */
-        if(!valid_entries_mask)
-            continue;
+int ht_node_delete_span(node_hashtable_t *hashtable, const void *key, size_t key_len)
+{
+    int ret = HASH_OK;
 
-        /* Extract every <key, entry> pair and insert in the new table */
-        while(valid_entries_mask)
-        {
-            size_t pos = _get_first_set_bit_pos(valid_entries_mask);
-            hashtable->destruct(table[cur_idx + pos].entry, table[cur_idx + pos].key);
+    /* Check user input - Spans are hashed by the table, so not in full hash mode */
+    if(HT_UNLIKELY(!key || !hashtable || hashtable->hash_full))
+        return HASH_WRONG_ARGUMENT;
 
-            /* Unset this entry */
-            valid_entries_mask ^= 1 << pos;
-        }
-    }
+    const size_t hash = _ht_node_hasher(key, key_len, hashtable->hash_seed);
+    ret = _ht_node_delete(hashtable, key, key_len, hash, 1);
 
-    /* Free the entries table and the structure itself */
-    free(hashtable->bitmap);
-    free(hashtable->table);
+    /* Also check if there is a need for rehashing */
+    if((hashtable->entries < LOWER_LIMIT(hashtable->hashtable_sz)) && hashtable->hashtable_sz != (2 * GROUP_SIZE))
+    {
+        /* Policy is size halving */
+        ret = _ht_node_resize(hashtable, hashtable->hashtable_sz >> 1);
+    }
+
+    return ret;
+}
+
+int ht_node_erase_it(node_hashtable_t *hashtable)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!hashtable))
+        return HASH_WRONG_ARGUMENT;
+
+    const size_t idx = hashtable->iterator.cur_idx;
+
+    /* No current element or already erased */
+    if(idx == SLOT_NOT_FOUND || (hashtable->bitmap[idx] & HIGH_BIT_MASK))
+        return HASH_ENTRY_NOT_EXISTS;
+
+    /* Put a tombstone only if there are no empty entries in the group */
+    const uint16_t empty_mask = _ht_eq_mask(&hashtable->bitmap[idx & ~((size_t)GROUP_SIZE - 1)], ENTRY_EMPTY);
+    hashtable->bitmap[idx] = (empty_mask) ? ENTRY_EMPTY : ENTRY_DELETED;
+
+    /* The rest of the group is already in the iterator mask - Shrinking is left to the next delete */
+    _ht_node_destruct(hashtable, _ht_node_slot(hashtable, idx));
+    hashtable->entries--;
+    HT_STAT_INC(hashtable, deletes);
+
+    return HASH_OK;
+}
+
+size_t ht_node_erase_if(node_hashtable_t *hashtable, int (*pred)(const void *key, void *entry, void *ctx), void *ctx)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!pred || !hashtable))
+        return 0;
+
+    size_t erased = 0;
+
+    /* Walk every group once */
+    for(size_t i = 0; i < hashtable->hashtable_sz; i += GROUP_SIZE)
+    {
+        uint8_t *bitmap_pos = &hashtable->bitmap[i];
+        uint16_t valid_mask = ~_ht_and_mask(bitmap_pos, HIGH_BIT_MASK);
+
+        /* Decided once per group - Probing never stops at a group without empty slots */
+        const uint8_t erased_ctrl = _ht_eq_mask(bitmap_pos, ENTRY_EMPTY) ? ENTRY_EMPTY : ENTRY_DELETED;
+
+        while(valid_mask)
+        {
+            size_t pos = _get_first_set_bit_pos(valid_mask);
+            node_pair_t *slot = _ht_node_slot(hashtable, i + pos);
+
+            if(pred(slot->key, _ht_node_entry(hashtable, slot), ctx))
+            {
+                bitmap_pos[pos] = erased_ctrl;
+                _ht_node_destruct(hashtable, slot);
+                erased++;
+            }
+
+            /* Unset this entry */
+            valid_mask ^= 1 << pos;
+        }
+    }
+
+    hashtable->entries -= erased;
+    HT_STAT_ADD(hashtable, deletes, erased);
+
+    /* A single resize for all the erased entries */
+    if(erased)
+    {
+        size_t new_sz = _get_shrink_capacity(hashtable->entries, hashtable->hashtable_sz);
+
+        if(new_sz != hashtable->hashtable_sz)
+            _ht_node_resize(hashtable, new_sz);
+    }
+
+    return erased;
+}
+
+int ht_node_clear(node_hashtable_t *hashtable, size_t retain_entries)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!hashtable))
+        return HASH_WRONG_ARGUMENT;
+
+
+    /* Destruct every entry */
+    for(size_t i = 0; i < hashtable->hashtable_sz; i += GROUP_SIZE)
+    {
+        uint16_t valid_entries_mask = ~(_ht_and_mask(&hashtable->bitmap[i], HIGH_BIT_MASK));
+
+        while(valid_entries_mask)
+        {
+            size_t pos = _get_first_set_bit_pos(valid_entries_mask);
+            _ht_node_destruct(hashtable, _ht_node_slot(hashtable, i + pos));
+
+            /* Unset this entry */
+            valid_entries_mask ^= 1 << pos;
+        }
+    }
+
+    /* Reset the control bytes and the state - The arrays are kept */
+    memset(hashtable->bitmap, ENTRY_EMPTY, hashtable->hashtable_sz * sizeof(uint8_t));
+    hashtable->entries = 0;
+    hashtable->iterator.iter_state = ITER_NOT_VALID;
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
+
+    /* Release the memory above the retained capacity */
+    if(retain_entries)
+    {
+        const size_t new_sz = _get_capacity_for_entries(retain_entries);
+
+        if(new_sz < hashtable->hashtable_sz)
+            return _ht_node_resize(hashtable, new_sz);
+    }
+
+    return HASH_OK;
+}
+
+void ht_node_free(node_hashtable_t *hashtable)
+{
+    /* Nothing to free, return */
+    if(!hashtable)
+        return;
+
+    const size_t num_of_groups = hashtable->hashtable_sz >> GROUP_SIZE_SHIFT;
+
+    /* Iterate over the table */
+    for(size_t i = 0; i < num_of_groups; i++)
+    {
+        /* Find empty_or_deleted -> Invert for the valid entries */
+        size_t cur_idx = i * GROUP_SIZE;
+        uint16_t valid_entries_mask = ~(_ht_and_mask(&hashtable->bitmap[cur_idx], HIGH_BIT_MASK));
+
+        /* This iteration step is trivial - No entries in this group */
+        if(!valid_entries_mask)
+            continue;
+
+        /* Extract every <key, entry> pair and insert in the new table */
+        while(valid_entries_mask)
+        {
+            size_t pos = _get_first_set_bit_pos(valid_entries_mask);
+            _ht_node_destruct(hashtable, _ht_node_slot(hashtable, cur_idx + pos));
+
+            /* Unset this entry */
+            valid_entries_mask ^= 1 << pos;
+        }
+    }
+
+    /* Free the entries table and the structure itself */
+    free(hashtable->bitmap);
+    free(hashtable->table);
     free(hashtable);
 }
 
@@ -513,6 +1017,7 @@ node_hashtable_tuple_t ht_node_start_it(node_hashtable_t *hashtable)
 {
     /* Iterator standard initialization */
     node_hashtable_tuple_t ret_iter = { .entry = NULL, .key = NULL };
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
     hashtable->iterator.iter_state = ITER_NOT_VALID;
 
     if(hashtable->entries)
@@ -524,10 +1029,11 @@ node_hashtable_tuple_t ht_node_start_it(node_hashtable_t *hashtable)
 
         size_t pos = _get_first_set_bit_pos(hashtable->iterator.cur_group_mask);
         hashtable->iterator.cur_group_mask ^= 1 << pos;
+        hashtable->iterator.cur_idx = (hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos;
 
         size_t idx = (hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos;
-        ret_iter.key = hashtable->table[idx].key;
-        ret_iter.entry = hashtable->table[idx].entry;
+        ret_iter.key = _ht_node_slot(hashtable, idx)->key;
+        ret_iter.entry = _ht_node_entry(hashtable, _ht_node_slot(hashtable, idx));
     }
 
     return ret_iter;
@@ -537,6 +1043,7 @@ node_hashtable_tuple_t ht_node_next_it(node_hashtable_t *hashtable)
 {
     /* Iterator standard initialization */
     node_hashtable_tuple_t ret_iter = { .entry = NULL, .key = NULL };
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
 
     if(hashtable->iterator.iter_state == ITER_VALID)
     {
@@ -558,10 +1065,11 @@ node_hashtable_tuple_t ht_node_next_it(node_hashtable_t *hashtable)
 
         size_t pos = _get_first_set_bit_pos(hashtable->iterator.cur_group_mask);
         hashtable->iterator.cur_group_mask ^= 1 << pos;
+        hashtable->iterator.cur_idx = (hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos;
 
         size_t idx = (hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos;
-        ret_iter.key = hashtable->table[idx].key;
-        ret_iter.entry = hashtable->table[idx].entry;
+        ret_iter.key = _ht_node_slot(hashtable, idx)->key;
+        ret_iter.entry = _ht_node_entry(hashtable, _ht_node_slot(hashtable, idx));
     }
 
     return ret_iter;
@@ -571,6 +1079,7 @@ node_hashtable_tuple_t ht_node_prev_it(node_hashtable_t *hashtable)
 {
     /* Iterator standard initialization */
     node_hashtable_tuple_t ret_iter = { .entry = NULL, .key = NULL };
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
 
     if(hashtable->iterator.iter_state == ITER_VALID)
     {
@@ -592,10 +1101,11 @@ node_hashtable_tuple_t ht_node_prev_it(node_hashtable_t *hashtable)
 
         size_t pos = _get_first_set_bit_pos(hashtable->iterator.cur_group_mask);
         hashtable->iterator.cur_group_mask ^= 1 << pos;
+        hashtable->iterator.cur_idx = (hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos;
 
         size_t idx = (hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos;
-        ret_iter.key = hashtable->table[idx].key;
-        ret_iter.entry = hashtable->table[idx].entry;
+        ret_iter.key = _ht_node_slot(hashtable, idx)->key;
+        ret_iter.entry = _ht_node_entry(hashtable, _ht_node_slot(hashtable, idx));
     }
 
     return ret_iter;
@@ -605,6 +1115,7 @@ node_hashtable_tuple_t ht_node_end_it(node_hashtable_t *hashtable)
 {
     /* Iterator standard initialization */
     node_hashtable_tuple_t ret_iter = { .entry = NULL, .key = NULL };
+    hashtable->iterator.cur_idx = SLOT_NOT_FOUND;
     hashtable->iterator.iter_state = ITER_NOT_VALID;
 
     if(hashtable->entries)
@@ -616,15 +1127,375 @@ node_hashtable_tuple_t ht_node_end_it(node_hashtable_t *hashtable)
 
         size_t pos = _get_first_set_bit_pos(hashtable->iterator.cur_group_mask);
         hashtable->iterator.cur_group_mask ^= 1 << pos;
+        hashtable->iterator.cur_idx = (hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos;
 
         size_t idx = (hashtable->iterator.cur_group << GROUP_SIZE_SHIFT) + pos;
-        ret_iter.key = hashtable->table[idx].key;
-        ret_iter.entry = hashtable->table[idx].entry;
+        ret_iter.key = _ht_node_slot(hashtable, idx)->key;
+        ret_iter.entry = _ht_node_entry(hashtable, _ht_node_slot(hashtable, idx));
     }
 
     return ret_iter;
 }
 
+/************************************ Merge Routines for Node ************************************/
+
+int ht_node_merge(node_hashtable_t *dst, node_hashtable_t *src, ht_merge_policy_t policy,
+                  void (*combine)(void *dst_entry, void *src_entry, void *ctx), void *ctx)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!dst || !src || dst == src || (policy == HT_MERGE_COMBINE && !combine)))
+        return HASH_WRONG_ARGUMENT;
+
+    /* Sets only merge into sets - Their slots have no entry */
+    if(HT_UNLIKELY((dst->slot_sz == NODE_SET_SLOT_SZ) != (src->slot_sz == NODE_SET_SLOT_SZ)))
+        return HASH_WRONG_ARGUMENT;
+
+    /* Views (clones without copies) do not own their references, so nothing moves in or out of them */
+    if(HT_UNLIKELY(dst->destruct == _ht_node_destruct_none || src->destruct == _ht_node_destruct_none))
+        return HASH_WRONG_ARGUMENT;
+
+    int error_code = HASH_OK;
+
+    /* Pre-size for the worst case (no common keys) - No resize happens midway */
+    if((error_code = ht_node_reserve(dst, dst->entries + src->entries)) != HASH_OK)
+        return error_code;
+
+    for(size_t i = 0; i < src->hashtable_sz; i += GROUP_SIZE)
+    {
+        uint16_t valid_mask = ~_ht_and_mask(&src->bitmap[i], HIGH_BIT_MASK);
+
+        while(valid_mask)
+        {
+            size_t pos = _get_first_set_bit_pos(valid_mask);
+            node_pair_t *src_slot = _ht_node_slot(src, i + pos);
+            int inserted;
+
+            /* Single probe in the destination - New pairs are moved over */
+            size_t key_len;
+            const size_t hash = _ht_node_hash_key(dst, src_slot->key, &key_len);
+            node_pair_t *dst_slot = _ht_node_find_or_insert(dst, src_slot->key, _ht_node_entry(src, src_slot), key_len, hash, &inserted, &error_code);
+
+            if(!inserted)
+            {
+                if(policy == HT_MERGE_OVERWRITE)
+                {
+                    /* Swap the references - The old ones of the destination are destructed */
+                    void *old_key = dst_slot->key;
+                    dst_slot->key = src_slot->key;
+                    src_slot->key = old_key;
+
+                    if(dst->slot_sz != NODE_SET_SLOT_SZ)
+                    {
+                        void *old_entry = dst_slot->entry;
+                        dst_slot->entry = src_slot->entry;
+                        src_slot->entry = old_entry;
+                    }
+                }
+                else if(policy == HT_MERGE_COMBINE)
+                {
+                    combine(_ht_node_entry(dst, dst_slot), _ht_node_entry(src, src_slot), ctx);
+                }
+
+                _ht_node_destruct(policy == HT_MERGE_OVERWRITE ? dst : src, src_slot);
+            }
+
+            /* Unset this entry */
+            valid_mask ^= 1 << pos;
+        }
+    }
+
+    /* Everything was moved out of the source */
+    memset(src->bitmap, ENTRY_EMPTY, src->hashtable_sz * sizeof(uint8_t));
+    src->entries = 0;
+    src->iterator.iter_state = ITER_NOT_VALID;
+    src->iterator.cur_idx = SLOT_NOT_FOUND;
+
+    return HASH_OK;
+}
+
+/************************************ Clone Routines for Node ************************************/
+
+node_hashtable_t *ht_node_clone(node_hashtable_t *src, int (*clone)(const void *key, const void *entry, void **key_copy, void **entry_copy), int *error_code)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!src || !error_code))
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
+    }
+
+    /* Identical capacity and layout */
+    node_hashtable_t *hashtable = _ht_node_create(src->hashtable_sz, src->slot_sz, src->comp, src->hash, error_code);
+
+    if(!hashtable)
+        return NULL;
+
+    /* Bulk copy - Same seed so every slot stays in place (along with the inline keys) */
+    memcpy(hashtable->bitmap, src->bitmap, src->hashtable_sz * sizeof(uint8_t));
+    memcpy(hashtable->table, src->table, src->hashtable_sz * src->slot_sz);
+    hashtable->entries = src->entries;
+    hashtable->hash_seed = src->hash_seed;
+    hashtable->hash_full = src->hash_full;
+
+    /* Without copies the clone is a view that does not own the references */
+    if(!clone)
+    {
+        hashtable->destruct = _ht_node_destruct_none;
+        return hashtable;
+    }
+
+    hashtable->destruct = src->destruct;
+    hashtable->destruct_key = src->destruct_key;
+
+    /* Deep copy of every pair */
+    for(size_t i = 0; i < hashtable->hashtable_sz; i += GROUP_SIZE)
+    {
+        uint16_t valid_mask = ~_ht_and_mask(&hashtable->bitmap[i], HIGH_BIT_MASK);
+
+        while(valid_mask)
+        {
+            size_t pos = _get_first_set_bit_pos(valid_mask);
+            node_pair_t *slot = _ht_node_slot(hashtable, i + pos);
+            void *key_copy = NULL, *entry_copy = NULL;
+
+            /* Sets have no entry to copy - The key reference doubles as the entry */
+            if(clone(slot->key, _ht_node_entry(hashtable, slot), &key_copy, &entry_copy))
+            {
+                /* Drop the rest of the pairs - Only the copies made so far are destructed */
+                memset(&hashtable->bitmap[i + pos], ENTRY_EMPTY, hashtable->hashtable_sz - (i + pos));
+
+                /* Along with the partial copies of the failed pair (the missing one is NULL) */
+                if(hashtable->slot_sz == NODE_SET_SLOT_SZ && key_copy)
+                    hashtable->destruct_key(key_copy);
+                else if(hashtable->slot_sz != NODE_SET_SLOT_SZ && (key_copy || entry_copy))
+                    hashtable->destruct(entry_copy, key_copy);
+
+                *error_code = HASH_CREATE_MEM_ALLOC;
+                ht_node_free(hashtable);
+                return NULL;
+            }
+
+            slot->key = key_copy;
+
+            if(hashtable->slot_sz != NODE_SET_SLOT_SZ)
+                slot->entry = entry_copy;
+
+            /* Unset this entry */
+            valid_mask ^= 1 << pos;
+        }
+    }
+
+    return hashtable;
+}
+
+/************************************ Prepared Routines for Node ************************************/
+
+ht_probe_t ht_node_prepare(node_hashtable_t *hashtable, const void *key)
+{
+    ht_probe_t probe = { .hash = 0, .seed = 0, .key_len = 0, .full_hash = 0 };
+
+    /* Check user input - An empty handle is returned */
+    if(HT_UNLIKELY(!key || !hashtable))
+        return probe;
+
+    probe.hash = _ht_node_hash_key(hashtable, key, &probe.key_len);
+    probe.seed = hashtable->hash_seed;
+    probe.full_hash = (hashtable->hash_full != NULL);
+
+    /* Bring the metadata group and the first slots of the group closer */
+    size_t i = ((probe.hash >> GROUP_H1_SHIFT) & (hashtable->group_num - 1)) * GROUP_SIZE;
+    HT_PREFETCH(&hashtable->bitmap[i]);
+    HT_PREFETCH(_ht_node_slot(hashtable, i));
+
+    return probe;
+}
+
+void *ht_node_search_prepared(node_hashtable_t *hashtable, const void *key, ht_probe_t probe)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!key || !hashtable))
+        return NULL;
+
+    /* Different seed or mode - The hash is not valid for this table */
+    if(HT_UNLIKELY(!_ht_node_probe_valid(hashtable, probe)))
+        probe.hash = _ht_node_hash_key(hashtable, key, &probe.key_len);
+
+    return _ht_node_search(hashtable, key, probe.key_len, probe.hash);
+}
+
+void *ht_node_insert_prepared(node_hashtable_t *hashtable, void *key, void *entry, ht_probe_t probe, int *error_code)
+{
+    /* Check user input - Sets have no entry (keys are added with set_add) */
+    if(HT_UNLIKELY(!key || !entry || !hashtable || !error_code || hashtable->slot_sz == NODE_SET_SLOT_SZ))
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
+    }
+
+    /* Set error code */
+    *error_code = HASH_OK;
+
+    /* Different seed or mode - The hash is not valid for this table */
+    if(HT_UNLIKELY(!_ht_node_probe_valid(hashtable, probe)))
+        probe.hash = _ht_node_hash_key(hashtable, key, &probe.key_len);
+
+    int inserted;
+    node_pair_t *slot = _ht_node_find_or_insert(hashtable, key, entry, probe.key_len, probe.hash, &inserted, error_code);
+
+    /* Existing entry is returned */
+    return (slot && !inserted) ? _ht_node_entry(hashtable, slot) : NULL;
+}
+
+int ht_node_delete_prepared(node_hashtable_t *hashtable, const void *key, ht_probe_t probe)
+{
+    int ret = HASH_OK;
+
+    /* Check user input */
+    if(HT_UNLIKELY(!key || !hashtable))
+        return HASH_WRONG_ARGUMENT;
+
+    /* Different seed or mode - The hash is not valid for this table */
+    if(HT_UNLIKELY(!_ht_node_probe_valid(hashtable, probe)))
+        probe.hash = _ht_node_hash_key(hashtable, key, &probe.key_len);
+
+    ret = _ht_node_delete(hashtable, key, probe.key_len, probe.hash, 0);
+
+    /* Also check if there is a need for rehashing */
+    if((hashtable->entries < LOWER_LIMIT(hashtable->hashtable_sz)) && hashtable->hashtable_sz != (2 * GROUP_SIZE))
+    {
+        /* Policy is size halving */
+        ret = _ht_node_resize(hashtable, hashtable->hashtable_sz >> 1);
+    }
+
+    return ret;
+}
+
+/************************************ Set Routines for Node ************************************/
+
+node_hashtable_t *ht_node_set_create(size_t hashtable_sz,
+                                     int (*comp)(const void *, const void *),
+                                     void (*destruct)(void *),
+                                     size_t (*hash)(const void *), int *error_code)
+{
+    /* Check input by the user - Necessary inputs */
+    if(!hashtable_sz || !comp || !destruct || !hash)
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return NULL;
+    }
+
+    node_hashtable_t *hashtable = _ht_node_create(_get_capacity_for_entries(hashtable_sz), NODE_SET_SLOT_SZ, comp, hash, error_code);
+
+    if(hashtable)
+        hashtable->destruct_key = destruct;
+
+    return hashtable;
+}
+
+int ht_node_set_contains(node_hashtable_t *hashtable, const void *key)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!key || !hashtable))
+        return 0;
+
+    size_t key_len;
+    const size_t hash = _ht_node_hash_key(hashtable, key, &key_len);
+
+    return _ht_node_search(hashtable, key, key_len, hash) != NULL;
+}
+
+int ht_node_set_add(node_hashtable_t *hashtable, void *key, int *error_code)
+{
+    /* Check user input - Only sets are accepted */
+    if(HT_UNLIKELY(!key || !hashtable || !error_code || hashtable->slot_sz != NODE_SET_SLOT_SZ))
+    {
+        *error_code = HASH_WRONG_ARGUMENT;
+        return 0;
+    }
+
+    /* Set error code */
+    *error_code = HASH_OK;
+
+    /* The key reference doubles as the entry, so searches return non NULL */
+    int inserted;
+    size_t key_len;
+    const size_t hash = _ht_node_hash_key(hashtable, key, &key_len);
+    _ht_node_find_or_insert(hashtable, key, key, key_len, hash, &inserted, error_code);
+
+    return inserted;
+}
+
+int ht_node_set_remove(node_hashtable_t *hashtable, const void *key)
+{
+    return ht_node_delete(hashtable, key);
+}
+
+const void *ht_node_set_start_it(node_hashtable_t *hashtable)
+{
+    return ht_node_start_it(hashtable).key;
+}
+
+const void *ht_node_set_next_it(node_hashtable_t *hashtable)
+{
+    return ht_node_next_it(hashtable).key;
+}
+
+int ht_node_reserve(node_hashtable_t *hashtable, size_t entries)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!hashtable))
+        return HASH_WRONG_ARGUMENT;
+
+    const size_t new_sz = _get_capacity_for_entries(entries);
+
+    /* Only grows */
+    if(new_sz <= hashtable->hashtable_sz)
+        return HASH_OK;
+
+    return _ht_node_resize(hashtable, new_sz);
+}
+
+int ht_node_shrink_to_fit(node_hashtable_t *hashtable)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!hashtable))
+        return HASH_WRONG_ARGUMENT;
+
+    const size_t new_sz = _get_capacity_for_entries(hashtable->entries);
+
+    if(new_sz > hashtable->hashtable_sz)
+        return HASH_OK;
+
+    /* Rehashing in the same size also clears the tombstones - They are not counted, so the groups are scanned */
+    if(new_sz == hashtable->hashtable_sz)
+    {
+        for(size_t i = 0; i < hashtable->hashtable_sz; i += GROUP_SIZE)
+        {
+            if(_ht_eq_mask(&hashtable->bitmap[i], ENTRY_DELETED))
+                return _ht_node_resize(hashtable, new_sz);
+        }
+
+        return HASH_OK;
+    }
+
+    return _ht_node_resize(hashtable, new_sz);
+}
+
+int ht_node_reseed(node_hashtable_t *hashtable, uint64_t seed)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!hashtable))
+        return HASH_WRONG_ARGUMENT;
+
+    /* Rehash in place with the new seed - Full hash mode never uses it */
+    hashtable->hash_seed = seed;
+
+    if(hashtable->hash_full)
+        return HASH_OK;
+
+    return _ht_node_resize(hashtable, hashtable->hashtable_sz);
+}
+
 size_t ht_node_get_entries(node_hashtable_t *hashtable)
 {
     return hashtable->entries;
@@ -643,10 +1514,10 @@ double ht_node_get_load_factor(node_hashtable_t *hashtable)
 void ht_node_print_mem_usage(node_hashtable_t *hashtable)
 {
     size_t bitmap_sz = hashtable->hashtable_sz;
-    size_t hashtable_sz = hashtable->hashtable_sz * sizeof(node_pair_t);
+    size_t hashtable_sz = hashtable->hashtable_sz * hashtable->slot_sz;
     size_t manager_structure_mem = sizeof(node_hashtable_t);
 
-    size_t valid_entries = hashtable->entries * sizeof(node_pair_t);
+    size_t valid_entries = hashtable->entries * hashtable->slot_sz;
     size_t valid_bitmap = hashtable->entries;
 
     size_t total_memory = bitmap_sz + hashtable_sz + manager_structure_mem;
@@ -658,3 +1529,67 @@ void ht_node_print_mem_usage(node_hashtable_t *hashtable)
     printf("Effective mem used(bytes): %ld\n", used_memory);
     printf("Memory util (bytes): %f\n", (double)used_memory / total_memory);
 }
+
+int ht_node_probe_stats(node_hashtable_t *hashtable, ht_probe_stats_t *stats)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!hashtable || !stats))
+        return HASH_WRONG_ARGUMENT;
+
+#ifdef SPARSE_LIN_PROBE
+    const int lin_probe = 1;
+#else
+    const int lin_probe = 0;
+#endif
+    const size_t group_mask = hashtable->group_num - 1;
+
+    memset(stats, 0, sizeof(ht_probe_stats_t));
+    stats->entries = hashtable->entries;
+    stats->capacity = hashtable->hashtable_sz;
+
+    /* Every resident key is rehashed to find the groups its lookup visits */
+    for(size_t i = 0; i < hashtable->group_num; i++)
+    {
+        uint16_t valid_entries_mask = ~(_ht_and_mask(&hashtable->bitmap[i * GROUP_SIZE], HIGH_BIT_MASK));
+
+        while(valid_entries_mask)
+        {
+            size_t pos = _get_first_set_bit_pos(valid_entries_mask);
+            node_pair_t *slot = _ht_node_slot(hashtable, i * GROUP_SIZE + pos);
+            size_t hash, key_len;
+
+            /* Same as the resize - Short keys are rehashed from the slot itself */
+            if(slot->key_tag != NODE_KEY_SPILLED)
+                hash = _ht_node_hasher(slot->key_data, slot->key_tag, hashtable->hash_seed);
+            else
+                hash = _ht_node_hash_key(hashtable, slot->key, &key_len);
+
+            _ht_probe_stats_add(stats, _ht_probe_len((hash >> GROUP_H1_SHIFT) & group_mask, i, group_mask, lin_probe));
+
+            /* Unset this entry */
+            valid_entries_mask ^= 1 << pos;
+        }
+    }
+
+    if(stats->entries)
+        stats->avg_probe /= stats->entries;
+
+    _ht_probe_stats_groups(stats, hashtable->bitmap, hashtable->group_num, lin_probe);
+
+    return HASH_OK;
+}
+
+int ht_node_get_stats(node_hashtable_t *hashtable, ht_op_stats_t *stats)
+{
+    /* Check user input */
+    if(HT_UNLIKELY(!hashtable || !stats))
+        return HASH_WRONG_ARGUMENT;
+
+#ifdef HT_STATS
+    *stats = hashtable->stats;
+#else
+    memset(stats, 0, sizeof(ht_op_stats_t));
+#endif
+
+    return HASH_OK;
+}
@@ -4,6 +4,9 @@
 #include <stddef.h>
 #include <stdlib.h>
 
+/* Types shared by both variants */
+#include "sparse_hashtable_types.h"
+
 /* Structure manager */
 typedef struct node_hashtable_struct node_hashtable_t;
 
@@ -37,14 +40,40 @@ typedef struct node_hashtable_tuple_struct
  *  - Destruct is the the destructor routine and user provides
  *  entry and key in order to be freed.
  *
- * Hashtable may not be the exact size as the user requested and may allocate extra memory
- * for internal reasons.
+ * Keys of up to 15 bytes (as reported by the hasher) are also copied inside the
+ * table, so their lookups are resolved without calling the comparator or touching
+ * the key itself. Keys are thus expected to be equal only when their bytes are.
+ *
+ * The size is the number of expected entries, so that many can be inserted without
+ * rehashing. Hashtable may allocate extra memory for internal reasons.
  */
 node_hashtable_t *ht_node_create(size_t hashtable_sz,
                                  int (*comp)(const void *, const void *),
                                  void (*destruct)(void *, void *),
                                  size_t (*hash)(const void *), int *error_code);
 
+/* **** ht_node_create_hashed ****
+ * @ Input arguments:
+ *        - size_t hashtable_size      : The initial hashtable size (expected entries)
+ *        - int (*comp)(...)           : The comparator of the keys
+ *        - void (*destruct)(...)      : The destructor of the entries
+ *        - uint64_t (*hash_full)(...) : Returns the final 64-bit hash of a key
+ *        - int error_code             : The error code, in case of failure
+ * @ Return value:
+ *        - node_hashtable_t *hashtable     : The hashtable structure manager
+ * @ Description:
+ *
+ * Same as ht_node_create(), but the hash callback provides the hash itself, which
+ * is used as is (low 7 bits for the metadata, the rest for the position). Keys with
+ * a cached hash or keys that are not contiguous in memory are never hashed by the
+ * table, so the hash has to be well distributed. Keys are not inlined in this mode
+ * and every comparison goes through the comparator.
+ */
+node_hashtable_t *ht_node_create_hashed(size_t hashtable_sz,
+                                        int (*comp)(const void *, const void *),
+                                        void (*destruct)(void *, void *),
+                                        uint64_t (*hash_full)(const void *), int *error_code);
+
 /* **** ht_flats_free ****
  * @ Input arguments:
  *        - flat_hashtable_t *hashtable : The hashtable structure manager
@@ -92,6 +121,28 @@ void *ht_node_search(node_hashtable_t *hashtable, const void *key);
  */
 void *ht_node_insert(node_hashtable_t *hashtable, void *key, void *entry, int *error_code);
 
+/* **** ht_node_emplace/ht_node_replace ****
+ * @ Input arguments:
+ *        - node_hashtable_t *hashtable : The hashtable structure manager
+ *        - void *key                   : The key to be inserted
+ *        - void *entry                 : The entry associated with the key
+ *        - int *error_code             : Error code for the status of the operation
+ * @ Return value:
+ *        - void *old_entry             : The old entry (NULL if it did not exist)
+ * @ Description:
+ *
+ * Emplace works like insert(), but if the key already exists only the entry reference
+ * is swapped in place (single probe, no destructor call) and the old entry is returned.
+ * Replace does the same only for existing keys and never inserts (the error code is
+ * HASH_ENTRY_NOT_EXISTS otherwise). Both are rejected on sets with HASH_WRONG_ARGUMENT.
+ *
+ * The stored key is kept (the destructor later runs on it), so the old entry and the
+ * key given to the call are not referenced by the table and belong to the user.
+ * Error code should be checked (in case or rehashing failure).
+ */
+void *ht_node_emplace(node_hashtable_t *hashtable, void *key, void *entry, int *error_code);
+void *ht_node_replace(node_hashtable_t *hashtable, void *key, void *entry, int *error_code);
+
 /* **** ht_flat_delete ****
  * @ Input arguments:
  *        - flat_hashtable_t *hashtable : The hashtable structure manager
@@ -104,12 +155,220 @@ void *ht_node_insert(node_hashtable_t *hashtable, void *key, void *entry, int *e
  * */
 int ht_node_delete(node_hashtable_t *hashtable, const void *key);
 
+/* **** ht_node_search_span/ht_node_delete_span ****
+ * @ Input arguments:
+ *        - node_hashtable_t *hashtable : The hashtable structure manager
+ *        - const void *key             : Start of the key bytes (not NUL terminated)
+ *        - size_t key_len              : Length of the key in bytes
+ * @ Return value:
+ *        - void *entry/int status      : Same as ht_node_search/ht_node_delete
+ * @ Description:
+ *
+ * Lookup and delete on a byte span, i.e a slice of a receive buffer, without copying
+ * it or calling the hash and comparator callbacks. The span matches the key whose first
+ * hash(key) bytes are equal to it, so the callbacks have to describe the key bytes
+ * (as strlen/strcmp do for strings). Spilled keys keep their length in the slot, so
+ * mismatches on long keys cost no dereference. Not available in full hash mode.
+ */
+void *ht_node_search_span(node_hashtable_t *hashtable, const void *key, size_t key_len);
+int ht_node_delete_span(node_hashtable_t *hashtable, const void *key, size_t key_len);
+
+/* **** ht_node_erase_if ****
+ * @ Input arguments:
+ *        - node_hashtable_t *hashtable : The hashtable structure manager
+ *        - int (*pred)(...)            : Predicate called with the key, the entry and ctx
+ *        - void *ctx                   : User context passed to the predicate
+ * @ Return value:
+ *        - size_t erased               : Number of erased entries
+ * @ Description:
+ *
+ * Erases every entry for which the predicate returns non zero (calling the destructor). The groups are
+ * walked once and the slots are marked in place, without re-hashing or probing.
+ * At most one resize is performed at the end. The predicate must not modify the table.
+ */
+size_t ht_node_erase_if(node_hashtable_t *hashtable, int (*pred)(const void *key, void *entry, void *ctx), void *ctx);
+
+/* **** ht_node_clear ****
+ * @ Input arguments:
+ *        - node_hashtable_t *hashtable : The hashtable structure manager
+ *        - size_t retain_entries       : Capacity to keep, in entries (0 keeps everything)
+ * @ Return value:
+ *        - int error_code              : The error code, in case of failure
+ * @ Description:
+ *
+ * Removes all the entries (calling the destructor) and keeps the allocated arrays, so the table can be
+ * reused without allocations or regrowing. If the table is larger than needed for
+ * retain_entries, the extra memory is released.
+ */
+int ht_node_clear(node_hashtable_t *hashtable, size_t retain_entries);
+
+/* ------------------------ Merge ------------------------ */
+
+/* **** ht_node_merge ****
+ * @ Input arguments:
+ *        - node_hashtable_t *dst       : The table that receives the entries
+ *        - node_hashtable_t *src       : The table whose entries are moved
+ *        - ht_merge_policy_t policy    : What to do with the keys found in both tables
+ *        - void (*combine)(...)        : Combines the source entry into the destination one
+ *        - void *ctx                   : User context passed to the combine callback
+ * @ Return value:
+ *        - int error_code              : The error code, in case of failure
+ * @ Description:
+ *
+ * Moves every entry of src into dst, leaving src empty (with its capacity kept). Both
+ * tables must use the same callbacks and be of the same kind (sets or maps), while views
+ * (clones without copies) are rejected. The destination is resized once beforehand from
+ * both entry counts, so each source key costs a single hash and probe. For common keys
+ * the entry that is not kept is destructed (after combine() in the combine policy).
+ */
+int ht_node_merge(node_hashtable_t *dst, node_hashtable_t *src, ht_merge_policy_t policy,
+                  void (*combine)(void *dst_entry, void *src_entry, void *ctx), void *ctx);
+
+/* ------------------------ Clone ------------------------ */
+
+/* **** ht_node_clone ****
+ * @ Input arguments:
+ *        - node_hashtable_t *src       : The table to be cloned
+ *        - int (*clone)(...)           : Copies a pair, returning non zero in failure (or NULL)
+ *        - int *error_code             : The error code, in case of failure
+ * @ Return value:
+ *        - node_hashtable_t *hashtable : The clone, NULL in case of failure
+ * @ Description:
+ *
+ * Creates a copy of the table with the same capacity, seed and layout, by copying
+ * the metadata and the slot arrays as they are (no rehashing). The clone callback
+ * gets every pair and provides the copies of the key and the entry, which are owned
+ * by the clone (for sets the entry copy is not kept). If the callback fails, the copies it
+ * already made for that pair are destructed (with NULL in place of the missing one).
+ *
+ * Without a callback the clone is a view that shares the references of the source and
+ * never destructs them, so it must not outlive it. Views cannot be merged (either way).
+ */
+node_hashtable_t *ht_node_clone(node_hashtable_t *src, int (*clone)(const void *key, const void *entry, void **key_copy, void **entry_copy), int *error_code);
+
+/* ------------------------ Prepared operations ------------------------ */
+
+/* **** ht_node_prepare ****
+ * @ Input arguments:
+ *        - node_hashtable_t *hashtable : The hashtable structure manager
+ *        - const void *key             : The key to be prepared
+ * @ Return value:
+ *        - ht_probe_t probe            : Handle for the prepared operations
+ * @ Description:
+ *
+ * First phase of a two-phase lookup. Computes the hash of the key and prefetches
+ * the group it maps to. The prepared operations work like their simple versions,
+ * without calling the hasher of the user or hashing the key again.
+ *
+ * The handle stays valid after insertion or delete and can also be used on other
+ * tables with the same callbacks and seed (see ht_node_reseed(), the hash is recomputed
+ * if the seed or the mode differs). Tables in full hash mode only need the same callbacks.
+ *
+ * A NULL table or key gives an empty handle (all zeros), which is not meant to be used.
+ */
+ht_probe_t ht_node_prepare(node_hashtable_t *hashtable, const void *key);
+void *ht_node_search_prepared(node_hashtable_t *hashtable, const void *key, ht_probe_t probe);
+void *ht_node_insert_prepared(node_hashtable_t *hashtable, void *key, void *entry, ht_probe_t probe, int *error_code);
+int ht_node_delete_prepared(node_hashtable_t *hashtable, const void *key, ht_probe_t probe);
+
+/* ------------------------ Sets ------------------------ */
+
+/* **** ht_node_set_create ****
+ * @ Input arguments:
+ *        - size_t hashtable_size      : The initial hashtable size
+ *        - comp/hash                  : Same as ht_node_create()
+ *        - destruct                   : Destructor of the key references
+ *        - int error_code             : The error code, in case of failure
+ * @ Return value:
+ *        - node_hashtable_t *hashtable     : The hashtable structure manager
+ * @ Description:
+ *
+ * Creates a hashtable that holds only key references (no payload), so there is
+ * no need to allocate a dummy entry for each key. The slots have no entry reference
+ * (24 instead of 32 bytes). Searches return the key reference as the entry, while
+ * insert(), emplace() and replace() (also the prepared insert) are rejected with
+ * HASH_WRONG_ARGUMENT, since there is no entry to store.
+ *
+ * Contains returns 1 if the key exists, add returns 1 if the key was inserted
+ * (the table now owns the reference) and 0 if it already existed. Remove has the
+ * same returns as delete(). Iterators return the key reference or NULL at the end.
+ */
+node_hashtable_t *ht_node_set_create(size_t hashtable_sz,
+                                     int (*comp)(const void *, const void *),
+                                     void (*destruct)(void *),
+                                     size_t (*hash)(const void *), int *error_code);
+int ht_node_set_contains(node_hashtable_t *hashtable, const void *key);
+int ht_node_set_add(node_hashtable_t *hashtable, void *key, int *error_code);
+int ht_node_set_remove(node_hashtable_t *hashtable, const void *key);
+const void *ht_node_set_start_it(node_hashtable_t *hashtable);
+const void *ht_node_set_next_it(node_hashtable_t *hashtable);
+
+/* ------------------------ Capacity ------------------------ */
+
+/* **** ht_node_reserve/ht_node_shrink_to_fit ****
+ * @ Input arguments:
+ *        - node_hashtable_t *hashtable : The hashtable structure manager
+ *        - size_t entries              : The number of entries to hold
+ * @ Return value:
+ *        - int error_code              : The error code, in case of failure
+ * @ Description:
+ *
+ * Reserve grows the table (with a single resize) so that the given number of entries
+ * can be inserted without any rehashing. Shrink to fit resizes the table to the smallest
+ * capacity that holds the current entries (also clearing the tombstones). The creation size is also interpreted
+ * as the number of expected entries.
+ */
+int ht_node_reserve(node_hashtable_t *hashtable, size_t entries);
+int ht_node_shrink_to_fit(node_hashtable_t *hashtable);
+
+/* **** ht_node_reseed ****
+ * @ Input arguments:
+ *        - node_hashtable_t *hashtable : The hashtable structure manager
+ *        - uint64_t seed               : The new seed of the hashers
+ * @ Return value:
+ *        - int error_code              : The error code, in case of failure
+ * @ Description:
+ *
+ * Every table hashes its keys with its own random seed, so different tables have
+ * different layouts. Reseed sets the seed explicitly (i.e so prepared handles can be
+ * reused across tables, or for reproducible layouts) and rehashes the table in place.
+ * Tables in full hash mode do not use the seed, so they are not rehashed.
+ */
+int ht_node_reseed(node_hashtable_t *hashtable, uint64_t seed);
+
 /* ------------------------ Utilities ------------------------ */
 size_t ht_node_get_entries(node_hashtable_t *hashtable);
 size_t ht_node_get_capacity(node_hashtable_t *hashtable);
 double ht_node_get_load_factor(node_hashtable_t *hashtable);
 void ht_node_print_mem_usage(node_hashtable_t *hashtable);
 
+/* **** ht_node_probe_stats ****
+ * @ Input arguments:
+ *        - node_hashtable_t *hashtable : The hashtable structure manager
+ *        - ht_probe_stats_t *stats     : Filled with the statistics of the table
+ * @ Return value:
+ *        - int error_code              : The error code, in case of failure
+ * @ Description:
+ *
+ * Probe length and clustering statistics (see ht_probe_stats_t), so a degraded table can
+ * be detected and rebuilt (i.e with a reserve that rehashes into a larger capacity).
+ * Every resident key is rehashed, so the call is linear on the capacity of the table.
+ */
+int ht_node_probe_stats(node_hashtable_t *hashtable, ht_probe_stats_t *stats);
+
+/* **** ht_node_get_stats ****
+ * @ Input arguments:
+ *        - node_hashtable_t *hashtable : The hashtable structure manager
+ *        - ht_op_stats_t *stats        : Filled with the operation counters of the table
+ * @ Return value:
+ *        - int error_code              : The error code, in case of failure
+ * @ Description:
+ *
+ * Snapshot of the operation counters (see ht_op_stats_t). The counters are kept only when
+ * the library is built with HT_STATS, otherwise the snapshot is all zeros.
+ */
+int ht_node_get_stats(node_hashtable_t *hashtable, ht_op_stats_t *stats);
+
 /* ------------------------ Iterators ------------------------ */
 
 /* Given the specified hashtable start/end iterator routines
@@ -130,4 +389,17 @@ node_hashtable_tuple_t ht_node_next_it(node_hashtable_t *hashtable);
 node_hashtable_tuple_t ht_node_prev_it(node_hashtable_t *hashtable);
 node_hashtable_tuple_t ht_node_end_it(node_hashtable_t *hashtable);
 
+/* **** ht_node_erase_it ****
+ * @ Input arguments:
+ *        - node_hashtable_t *hashtable : The hashtable structure manager
+ * @ Return value:
+ *        - int error_code              : 0 for success or HASH_ENTRY_NOT_EXISTS
+ * @ Description:
+ *
+ * Erases the element last returned by the iterator in O(1) (calling the destructor), without re-hashing
+ * or probing. The iterator stays valid, so next/prev can be called afterwards. Shrinking
+ * is postponed until the next delete.
+ */
+int ht_node_erase_it(node_hashtable_t *hashtable);
+
 #endif   // __NODE_SPARSE_HASHTABLE_H //
@@ -14,6 +14,9 @@
 /* Hash functors and mixers */
 #include "hash_function.h"
 
+/* Public types shared by both variants */
+#include "sparse_hashtable_types.h"
+
 /****************************** INTRINSICS/INSTRUCTIONS & COMPILER SETTINGS ******************************/
 
 /* Branch prediction related */
@@ -21,9 +24,11 @@
     #define INSTR_BUILTINS
     #define HT_LIKELY(x)   (__builtin_expect(x, 1))
     #define HT_UNLIKELY(x) (__builtin_expect(x, 0))
+    #define HT_PREFETCH(x) (__builtin_prefetch(x))
 #else
     #define HT_LIKELY(x)   (x)
     #define HT_UNLIKELY(x) (x)
+    #define HT_PREFETCH(x) ((void)(x))
 #endif
 
 /* SSE instructions to use on bitmasks */
@@ -62,6 +67,15 @@ typedef enum hashtable_error_code_enum
     HASH_ENTRY_NOT_EXISTS = 5,   // Entry does not exist when trying to delete it //
 } hash_err_t;
 
+/* Operation counters - Compiled in only with HT_STATS */
+#ifdef HT_STATS
+    #define HT_STAT_INC(ht, counter)    ((ht)->stats.counter++)
+    #define HT_STAT_ADD(ht, counter, x) ((ht)->stats.counter += (x))
+#else
+    #define HT_STAT_INC(ht, counter)    ((void)0)
+    #define HT_STAT_ADD(ht, counter, x) ((void)0)
+#endif
+
 /* Iterator status */
 #define ITER_VALID     1
 #define ITER_NOT_VALID 0
@@ -76,10 +90,14 @@ typedef enum hashtable_error_code_enum
 typedef struct hashtable_iter_struct
 {
     size_t cur_group;
+    size_t cur_idx; /* Slot of the last returned element */
     uint16_t cur_group_mask;
     uint8_t iter_state;
 } hashtable_iter_t;
 
+/* Returned by the index based lookups when there is no such key */
+#define SLOT_NOT_FOUND ((size_t)-1)
+
 /* Opcodes for each entry */
 #define ENTRY_VALID   0x00
 #define ENTRY_DELETED 0x80
@@ -132,6 +150,47 @@ static inline size_t _get_next_power_of_two(size_t size)
     return size + 1;
 }
 
+/* Seed of a new table - Mixes the time, the address of the table and a creation counter,
+ * so tables created together still get different layouts */
+static inline uint64_t _ht_generate_seed(const void *hashtable)
+{
+    static uint64_t counter = 0;
+
+    return fmix64((uint64_t)time(NULL) ^ (uint64_t)(uintptr_t)hashtable ^ (++counter * 0x9e3779b97f4a7c15ULL));
+}
+
+/* Smallest power of 2 capacity (at least 2 groups) that holds the entries under the upper limit */
+static inline size_t _get_capacity_for_entries(size_t entries)
+{
+    size_t size = 2 * GROUP_SIZE;
+
+    while(UPPER_LIMIT(size) < entries)
+        size <<= 1;
+
+    return size;
+}
+
+/* Capacity after repeated halving, as long as the entries are under the lower limit */
+static inline size_t _get_shrink_capacity(size_t entries, size_t size)
+{
+    while(size > 2 * GROUP_SIZE && entries < LOWER_LIMIT(size))
+        size >>= 1;
+
+    return size;
+}
+
+#ifdef HT_STATS
+/* Monotonic timestamp for the rehash time counter */
+static inline uint64_t _ht_stat_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
 /* Used to get position of the rightmost set bit (Indexes start at 0) */
 static inline size_t _get_first_set_bit_pos(uint32_t x)
 {
@@ -265,4 +324,70 @@ static inline uint16_t _ht_and_mask(uint8_t *group_meta, uint8_t ctrl_mask)
 #endif
 }
 
+/* Groups visited by a lookup that starts from the home group and stops at the target group.
+ * The probing technique is defined per variant, so it is passed on each call. */
+static inline size_t _ht_probe_len(size_t home_group, size_t target_group, size_t group_mask, int lin_probe)
+{
+    size_t group_idx = home_group;
+    size_t probe_step = 1;
+    size_t len = 1;
+
+    while(group_idx != target_group)
+    {
+        group_idx = (group_idx + (lin_probe ? 1 : probe_step)) & group_mask;
+        probe_step++;
+        len++;
+    }
+
+    return len;
+}
+
+/* Adds the probe length of a resident key to the statistics */
+static inline void _ht_probe_stats_add(ht_probe_stats_t *stats, size_t len)
+{
+    stats->probe_hist[(len < HT_PROBE_HIST_BUCKETS) ? len - 1 : HT_PROBE_HIST_BUCKETS - 1]++;
+    stats->avg_probe += len;
+
+    if(len > stats->max_probe)
+        stats->max_probe = len;
+}
+
+/* Group level part of the statistics - Tombstones, full groups and the probe length of a miss
+ * from every home group (a miss stops at the first group with an empty slot) */
+static inline void _ht_probe_stats_groups(ht_probe_stats_t *stats, uint8_t *bitmap, size_t group_num, int lin_probe)
+{
+    const size_t group_mask = group_num - 1;
+
+    for(size_t g = 0; g < group_num; g++)
+    {
+        uint8_t *bitmap_pos = &bitmap[g * GROUP_SIZE];
+
+        /* Tombstones and full groups */
+        for(uint16_t mask = _ht_eq_mask(bitmap_pos, ENTRY_DELETED); mask; mask &= mask - 1)
+            stats->tombstones++;
+
+        if(!_ht_eq_mask(bitmap_pos, ENTRY_EMPTY))
+            stats->full_groups++;
+
+        /* Miss from this home group - Bounded, since a table always has an empty slot */
+        size_t group_idx = g;
+        size_t probe_step = 1;
+        size_t len = 1;
+
+        while(!_ht_eq_mask(&bitmap[group_idx * GROUP_SIZE], ENTRY_EMPTY) && len <= group_num)
+        {
+            group_idx = (group_idx + (lin_probe ? 1 : probe_step)) & group_mask;
+            probe_step++;
+            len++;
+        }
+
+        stats->avg_miss_probe += len;
+
+        if(len > stats->max_miss_probe)
+            stats->max_miss_probe = len;
+    }
+
+    stats->avg_miss_probe /= group_num;
+}
+
 #endif   // _HASHTABLE_COMMON_H //
@@ -0,0 +1,96 @@
+#ifndef __SPARSE_HASHTABLE_TYPES_H
+#define __SPARSE_HASHTABLE_TYPES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Types shared by the public API of both variants */
+
+/* **** ht_probe_t ****
+ *
+ * Handle of a prepared lookup. Holds the hash of the key (along with the seed
+ * and the mode it was computed with) so the key is not hashed again by the prepared
+ * operations. A handle can be used on any table with the same hashing scheme, for
+ * tables with a different seed or mode the hash is simply recomputed.
+ */
+typedef struct ht_probe_struct
+{
+    uint64_t hash;
+    uint64_t seed;
+    size_t key_len;    /* Node only - Length reported by the hasher */
+    uint8_t full_hash; /* Node only - Hash of the full hash callback (the seed is not used) */
+} ht_probe_t;
+
+/* **** ht_merge_policy_t ****
+ *
+ * What a merge does with the keys that exist in both tables.
+ *  - HT_MERGE_KEEP      : The entry of the destination is kept
+ *  - HT_MERGE_OVERWRITE : The entry of the source replaces it
+ *  - HT_MERGE_COMBINE   : A user callback combines the source entry into the destination one
+ */
+typedef enum ht_merge_policy_enum
+{
+    HT_MERGE_KEEP,
+    HT_MERGE_OVERWRITE,
+    HT_MERGE_COMBINE
+} ht_merge_policy_t;
+
+/* **** ht_probe_stats_t ****
+ *
+ * Probe length and clustering statistics of a table. A probe length is the number
+ * of groups visited by a lookup, so 1 means the key was found in its home group.
+ *  - probe_hist     : Resident keys found after i+1 groups (the last bucket also counts the longer ones)
+ *  - avg_miss_probe : Expected groups visited by a miss (uniform over the home groups)
+ *  - full_groups    : Groups without an empty slot, i.e groups that a miss must probe past
+ */
+#define HT_PROBE_HIST_BUCKETS 16
+
+typedef struct ht_probe_stats_struct
+{
+    size_t entries;
+    size_t capacity;
+    size_t tombstones;
+    size_t full_groups;
+
+    size_t probe_hist[HT_PROBE_HIST_BUCKETS];
+    size_t max_probe;
+    double avg_probe;
+
+    size_t max_miss_probe;
+    double avg_miss_probe;
+} ht_probe_stats_t;
+
+/* **** ht_op_stats_t ****
+ *
+ * Operation counters of a table, kept only when the library is built with HT_STATS
+ * (i.e -DHT_STATS), so they cost nothing otherwise. The counters start at zero on
+ * creation and are never reset, so they can be scraped periodically.
+ *  - searches       : Lookups (hits + misses), including the multimap ones
+ *  - inserts        : New keys stored by every kind of insertion
+ *  - duplicates     : Insertions that found the key (emplaces included)
+ *  - deletes        : Erased entries (by key, iterator, predicate or eviction)
+ *  - resizes_*      : Rehashes to a larger/smaller capacity, rehashes counts the same capacity ones
+ *  - rehash_ns      : Total time spent on all of the above
+ *  - moved          : Entries moved by all of the above
+ *  - groups_probed  : Groups visited by the lookups of searches, inserts and deletes
+ */
+typedef struct ht_op_stats_struct
+{
+    uint64_t searches;
+    uint64_t hits;
+    uint64_t misses;
+
+    uint64_t inserts;
+    uint64_t duplicates;
+    uint64_t deletes;
+
+    uint64_t resizes_up;
+    uint64_t resizes_down;
+    uint64_t rehashes;
+    uint64_t rehash_ns;
+    uint64_t moved;
+
+    uint64_t groups_probed;
+} ht_op_stats_t;
+
+#endif   // __SPARSE_HASHTABLE_TYPES_H //
@@ -4,6 +4,7 @@
 
 #include "flat_sparse_hashtable.h"
 #include "node_sparse_hashtable.h"
+#include "hash_function.h"
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -606,6 +607,1013 @@ void test_iterators(int print_flag)
     free(test_entries);
 }
 
+/* Operation counters - Exact with HT_STATS, all zeros otherwise */
+void test_op_stats(int print_flag)
+{
+    int test_size = 100000;
+    int op_error_code = 0;
+    int entry = 0;
+    ht_op_stats_t stats;
+
+    if(print_flag)
+        printf("\n*************** Testing operation counters ***************\n");
+
+    flat_hashtable_t *hashtable = ht_flat_create(4, INTEGER_4BYTE, INTEGER_4BYTE, &op_error_code);
+
+    /* Every key is inserted twice, searched once and half of the keys are missed */
+    for(int i = 0; i < test_size; i++)
+    {
+        ht_flat_insert(hashtable, &i, &entry, &op_error_code);
+        ht_flat_insert(hashtable, &i, &entry, &op_error_code);
+    }
+
+    for(int i = test_size / 2; i < test_size + test_size / 2; i++)
+        ht_flat_search(hashtable, &i);
+
+    for(int i = 0; i < test_size; i += 2)
+        ht_flat_delete(hashtable, &i);
+
+    if(ht_flat_get_stats(hashtable, &stats) != 0 || ht_flat_get_stats(NULL, &stats) != 2)
+    {
+        printf("Operation counters not working properly | Exiting...\n");
+        exit(1);
+    }
+
+#ifdef HT_STATS
+    if(stats.inserts != test_size || stats.duplicates != test_size || stats.searches != test_size || stats.hits != test_size / 2
+       || stats.misses != test_size / 2 || stats.deletes != test_size / 2 || !stats.resizes_up || !stats.moved
+       || stats.groups_probed < 2 * test_size + test_size + test_size / 2)
+#else
+    if(stats.inserts || stats.searches || stats.deletes || stats.resizes_up || stats.groups_probed)
+#endif
+    {
+        printf("Operation counters not consistent -> %lu inserts - %lu searches | Exiting...\n", (unsigned long)stats.inserts,
+               (unsigned long)stats.searches);
+        exit(1);
+    }
+
+    if(print_flag)
+    {
+        printf("Inserts %lu (%lu duplicates) - Searches %lu (%lu hits) - Deletes %lu - Resizes %lu up %lu down (%lu moved in %.3f ms) - "
+               "Groups probed %lu\n",
+               (unsigned long)stats.inserts, (unsigned long)stats.duplicates, (unsigned long)stats.searches, (unsigned long)stats.hits,
+               (unsigned long)stats.deletes, (unsigned long)stats.resizes_up, (unsigned long)stats.resizes_down, (unsigned long)stats.moved,
+               stats.rehash_ns / 1e6, (unsigned long)stats.groups_probed);
+    }
+
+    ht_flat_free(hashtable);
+}
+
+/* Probe length statistics - The histogram covers every key and a rehash clears the tombstones */
+void test_probe_stats(int print_flag)
+{
+    int test_size = 100000;
+    int op_error_code = 0;
+    int entry = 0;
+    ht_probe_stats_t stats;
+
+    if(print_flag)
+        printf("\n*************** Testing probe statistics ***************\n");
+
+    flat_hashtable_t *hashtable = ht_flat_create(test_size, INTEGER_4BYTE, INTEGER_4BYTE, &op_error_code);
+
+    for(int i = 0; i < test_size; i++)
+        ht_flat_insert(hashtable, &i, &entry, &op_error_code);
+
+    /* Remove every third key to leave some tombstones behind */
+    for(int i = 0; i < test_size; i += 3)
+        ht_flat_delete(hashtable, &i);
+
+    for(int round = 0; round < 2; round++)
+    {
+        size_t hist_sum = 0;
+
+        if(ht_flat_probe_stats(hashtable, &stats) != 0 || ht_flat_probe_stats(NULL, &stats) != 2)
+        {
+            printf("Probe stats not working properly | Exiting...\n");
+            exit(1);
+        }
+
+        for(int i = 0; i < HT_PROBE_HIST_BUCKETS; i++)
+            hist_sum += stats.probe_hist[i];
+
+        if(hist_sum != stats.entries || stats.entries != ht_flat_get_entries(hashtable) || stats.capacity != ht_flat_get_capacity(hashtable)
+           || stats.avg_probe < 1 || stats.max_probe < 1 || stats.avg_miss_probe < 1 || stats.max_miss_probe < 1
+           || stats.full_groups > stats.capacity / 16 || (round && stats.tombstones))
+        {
+            printf("Probe stats not consistent -> %zu keys in histogram (round %d) | Exiting...\n", hist_sum, round);
+            exit(1);
+        }
+
+        if(print_flag)
+        {
+            printf("Round %d: %zu entries - %zu tombstones - %zu full groups - probe avg %.3f max %zu - miss avg %.3f max %zu\n", round,
+                   stats.entries, stats.tombstones, stats.full_groups, stats.avg_probe, stats.max_probe, stats.avg_miss_probe,
+                   stats.max_miss_probe);
+        }
+
+        /* Rehash in place for the next round */
+        ht_flat_reseed(hashtable, 42);
+    }
+
+    ht_flat_free(hashtable);
+}
+
+/* Hashing throughput of the available hashers across key lengths */
+void test_hash_throughput(int print_flag)
+{
+    const size_t lengths[] = { 4, 8, 16, 32, 64, 256 };
+    const size_t total_bytes = 1 << 28;
+    char *buffer = malloc(256 + 64);
+    volatile uint64_t sink = 0;
+
+    if(print_flag)
+        printf("\n*************** Testing hash throughput (ns per hash) ***************\n");
+
+    for(size_t i = 0; i < 256 + 64; i++)
+        buffer[i] = rand();
+
+    for(size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+    {
+        const size_t len = lengths[l];
+        const size_t iters = total_bytes / len;
+        clock_t start_t, oaat_t, city_t, wy_t;
+        uint64_t h = 0;
+
+        /* Chained through the offset so that the calls cannot be overlapped or hoisted */
+        start_t = clock();
+        for(size_t i = 0; i < iters; i++)
+            h += hash_MurmurOAAT64(buffer + (h & 63), len);
+        oaat_t = clock() - start_t;
+
+        start_t = clock();
+        for(size_t i = 0; i < iters; i++)
+            h += hash_CityHash64WithSeed(buffer + (h & 63), len, i);
+        city_t = clock() - start_t;
+
+        start_t = clock();
+        for(size_t i = 0; i < iters; i++)
+            h += hash_wyhash(buffer + (h & 63), len, i);
+        wy_t = clock() - start_t;
+
+        sink += h;
+
+        if(print_flag)
+        {
+            printf("%3zu-byte keys: MurmurOAAT64 %7.2f - CityHash64 %7.2f - wyhash %7.2f\n", len, (double)oaat_t / CLOCKS_PER_SEC * NS_TIME / iters,
+                   (double)city_t / CLOCKS_PER_SEC * NS_TIME / iters, (double)wy_t / CLOCKS_PER_SEC * NS_TIME / iters);
+        }
+    }
+
+    free(buffer);
+}
+
+/* Testing of per table seeds (copying between tables in iteration order) */
+void test_seeds(int print_flag)
+{
+    int test_size = 1000000;
+    int op_error_code = 0;
+    clock_t start_t, same_t, diff_t;
+
+    if(print_flag)
+        printf("\n*************** Testing seeds ***************\n");
+
+    flat_hashtable_t *hashtable = ht_flat_create(test_size, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+    for(int i = 0; i < test_size; i++)
+    {
+        long int entry = i;
+        ht_flat_insert(hashtable, &i, &entry, &op_error_code);
+    }
+
+    /* Copy into a growing table with the same layout */
+    flat_hashtable_t *same = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+    ht_flat_reseed(hashtable, 1);
+    ht_flat_reseed(same, 1);
+
+    start_t = clock();
+
+    for(flat_hashtable_tuple_t it = ht_flat_start_it(hashtable); it.key; it = ht_flat_next_it(hashtable))
+        ht_flat_insert(same, it.key, it.entry, &op_error_code);
+
+    same_t = clock() - start_t;
+
+    /* Same copy with a different seed */
+    flat_hashtable_t *diff = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+    start_t = clock();
+
+    for(flat_hashtable_tuple_t it = ht_flat_start_it(hashtable); it.key; it = ht_flat_next_it(hashtable))
+        ht_flat_insert(diff, it.key, it.entry, &op_error_code);
+
+    diff_t = clock() - start_t;
+
+    for(int i = 0; i < test_size; i++)
+    {
+        long int *entry = ht_flat_search(diff, &i);
+
+        if(!entry || *entry != i || !ht_flat_search(same, &i) || !ht_flat_search(hashtable, &i))
+        {
+            printf("Seeds not working properly -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    if(print_flag)
+        printf("Copy in iteration order with same seed %f sec - Different seeds %f sec\n", (double)same_t / CLOCKS_PER_SEC, (double)diff_t / CLOCKS_PER_SEC);
+
+    ht_flat_free(hashtable);
+    ht_flat_free(same);
+    ht_flat_free(diff);
+}
+
+/* Testing of cloning (copy on write snapshots) */
+void test_clone(int print_flag)
+{
+    int test_size = 1000000;
+    int op_error_code = 0;
+    clock_t start_t, insert_t, clone_t;
+
+    if(print_flag)
+        printf("\n*************** Testing clone ***************\n");
+
+    flat_hashtable_t *hashtable = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+    for(int i = 0; i < test_size; i++)
+    {
+        long int entry = i;
+        ht_flat_insert(hashtable, &i, &entry, &op_error_code);
+    }
+
+    /* Snapshot by iterating and inserting */
+    start_t = clock();
+    flat_hashtable_t *copy = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+    for(flat_hashtable_tuple_t it = ht_flat_start_it(hashtable); it.key; it = ht_flat_next_it(hashtable))
+        ht_flat_insert(copy, it.key, it.entry, &op_error_code);
+
+    insert_t = clock() - start_t;
+
+    /* Snapshot by cloning */
+    start_t = clock();
+    flat_hashtable_t *snapshot = ht_flat_clone(hashtable, &op_error_code);
+    clone_t = clock() - start_t;
+
+    /* Writes on the source are not visible to the snapshot */
+    for(int i = 0; i < test_size; i += 2)
+        ht_flat_delete(hashtable, &i);
+
+    for(int i = 0; i < test_size; i++)
+    {
+        long int *entry = ht_flat_search(snapshot, &i);
+
+        if(!entry || *entry != i)
+        {
+            printf("Clone not working properly -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    if(ht_flat_get_entries(snapshot) != test_size || ht_flat_get_capacity(snapshot) != ht_flat_get_capacity(copy))
+    {
+        printf("Clone sizes not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    if(print_flag)
+        printf("Snapshot by inserting %f sec - Cloning %f sec\n", (double)insert_t / CLOCKS_PER_SEC, (double)clone_t / CLOCKS_PER_SEC);
+
+    ht_flat_free(hashtable);
+    ht_flat_free(copy);
+    ht_flat_free(snapshot);
+}
+
+/* Combine callback - Sums the partial counters */
+void merge_sum(void *dst_entry, const void *src_entry, void *ctx)
+{
+    *(long int *)dst_entry += *(const long int *)src_entry;
+}
+
+/* Testing of table merging (per thread partial counters reduced in one table) */
+void test_merge(int print_flag)
+{
+    int parts = 4;
+    int test_size = 250000;
+    int op_error_code = 0;
+    long int one = 1;
+    clock_t start_t, insert_t, merge_t;
+    flat_hashtable_t *partial[4];
+
+    if(print_flag)
+        printf("\n*************** Testing merge ***************\n");
+
+    /* Part p counts the keys [p * test_size / 2, p * test_size / 2 + test_size) - Halves overlap */
+    for(int p = 0; p < parts; p++)
+    {
+        partial[p] = ht_flat_create(test_size, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+        for(int i = p * test_size / 2; i < p * test_size / 2 + test_size; i++)
+            ht_flat_insert(partial[p], &i, &one, &op_error_code);
+    }
+
+    /* Reduce by iterating and inserting */
+    start_t = clock();
+    flat_hashtable_t *reduced = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+    for(int p = 0; p < parts; p++)
+    {
+        for(flat_hashtable_tuple_t it = ht_flat_start_it(partial[p]); it.key; it = ht_flat_next_it(partial[p]))
+        {
+            long int *count = ht_flat_insert(reduced, it.key, it.entry, &op_error_code);
+
+            if(count)
+                *count += *(long int *)it.entry;
+        }
+    }
+
+    insert_t = clock() - start_t;
+
+    /* Reduce by merging */
+    start_t = clock();
+    flat_hashtable_t *merged = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+    for(int p = 0; p < parts; p++)
+        ht_flat_merge(merged, partial[p], HT_MERGE_COMBINE, merge_sum, NULL);
+
+    merge_t = clock() - start_t;
+
+    if(ht_flat_get_entries(merged) != ht_flat_get_entries(reduced) || ht_flat_get_entries(partial[0]) != test_size)
+    {
+        printf("Merge not working properly -> %zu | Exiting...\n", ht_flat_get_entries(merged));
+        exit(1);
+    }
+
+    for(flat_hashtable_tuple_t it = ht_flat_start_it(reduced); it.key; it = ht_flat_next_it(reduced))
+    {
+        long int *count = ht_flat_search(merged, it.key);
+
+        if(!count || *count != *(long int *)it.entry)
+        {
+            printf("Merge combined wrong counters -> %d | Exiting...\n", *(int *)it.key);
+            exit(1);
+        }
+    }
+
+    /* Keep and overwrite policies on the common keys of parts 0 and 1 */
+    int common = test_size / 2;
+    long int *kept, *overwritten;
+
+    flat_hashtable_t *keep = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+    ht_flat_merge(keep, merged, HT_MERGE_KEEP, NULL, NULL);
+    ht_flat_merge(keep, partial[0], HT_MERGE_KEEP, NULL, NULL);
+    kept = ht_flat_search(keep, &common);
+
+    ht_flat_merge(merged, partial[0], HT_MERGE_OVERWRITE, NULL, NULL);
+    overwritten = ht_flat_search(merged, &common);
+
+    if(!kept || *kept != 2 || !overwritten || *overwritten != 1)
+    {
+        printf("Merge policies not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    /* Empty destinations keep their seed - Arrays are copied only when the seeds already match */
+    ht_probe_t src_probe = ht_flat_prepare(partial[0], &common);
+    flat_hashtable_t *copied = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+    ht_flat_reseed(copied, src_probe.seed);
+    ht_flat_merge(copied, partial[0], HT_MERGE_KEEP, NULL, NULL);
+
+    if(ht_flat_prepare(keep, &common).seed == ht_flat_prepare(merged, &common).seed || ht_flat_get_entries(copied) != test_size
+       || ht_flat_search(copied, &common) == NULL || ht_flat_prepare(copied, &common).seed != src_probe.seed)
+    {
+        printf("Merge into empty tables not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    ht_flat_free(copied);
+
+    if(print_flag)
+        printf("Reduce of %d tables by inserting %f sec - Merging %f sec\n", parts, (double)insert_t / CLOCKS_PER_SEC, (double)merge_t / CLOCKS_PER_SEC);
+
+    for(int p = 0; p < parts; p++)
+        ht_flat_free(partial[p]);
+
+    ht_flat_free(reduced);
+    ht_flat_free(merged);
+    ht_flat_free(keep);
+}
+
+/* Testing of clear (scratch tables reused without allocations) */
+void test_clear(int print_flag)
+{
+    int cycles = 1000;
+    int test_size = 1000;
+    int op_error_code = 0;
+    clock_t start_t, recreate_t, clear_t;
+
+    if(print_flag)
+        printf("\n*************** Testing clear ***************\n");
+
+    /* Scratch table freed and created on every cycle */
+    start_t = clock();
+
+    for(int c = 0; c < cycles; c++)
+    {
+        flat_hashtable_t *hashtable = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+        for(int i = 0; i < test_size; i++)
+        {
+            long int entry = i;
+            ht_flat_insert(hashtable, &i, &entry, &op_error_code);
+        }
+
+        ht_flat_free(hashtable);
+    }
+
+    recreate_t = clock() - start_t;
+
+    /* Same scratch table cleared on every cycle */
+    start_t = clock();
+    flat_hashtable_t *hashtable = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+    for(int c = 0; c < cycles; c++)
+    {
+        ht_flat_clear(hashtable, 0);
+
+        for(int i = c; i < test_size + c; i++)
+        {
+            long int entry = i;
+            ht_flat_insert(hashtable, &i, &entry, &op_error_code);
+        }
+    }
+
+    clear_t = clock() - start_t;
+
+    /* Only the last cycle remains */
+    for(int i = 0; i < test_size + cycles; i++)
+    {
+        if((ht_flat_search(hashtable, &i) != NULL) != (i >= cycles - 1 && i < test_size + cycles - 1))
+        {
+            printf("Clear not working properly -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    /* Clearing with a retained capacity releases the rest */
+    size_t capacity = ht_flat_get_capacity(hashtable);
+
+    if(ht_flat_clear(hashtable, 0) || ht_flat_get_capacity(hashtable) != capacity || ht_flat_get_entries(hashtable) ||
+       ht_flat_clear(hashtable, 10) || ht_flat_get_capacity(hashtable) != 32 || ht_flat_start_it(hashtable).key)
+    {
+        printf("Clear capacity not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    if(print_flag)
+        printf("Scratch cycles recreating %f sec - Clearing %f sec\n", (double)recreate_t / CLOCKS_PER_SEC, (double)clear_t / CLOCKS_PER_SEC);
+
+    ht_flat_free(hashtable);
+}
+
+/* Testing of reserve and shrink to fit (bulk loads without resizes) */
+void test_reserve(int print_flag)
+{
+    int test_size = 1000000;
+    int op_error_code = 0;
+    clock_t start_t, grow_t, reserve_t;
+
+    if(print_flag)
+        printf("\n*************** Testing reserve ***************\n");
+
+    /* Bulk load with the table growing */
+    start_t = clock();
+    flat_hashtable_t *hashtable = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+    for(int i = 0; i < test_size; i++)
+    {
+        long int entry = i;
+        ht_flat_insert(hashtable, &i, &entry, &op_error_code);
+    }
+
+    grow_t = clock() - start_t;
+    ht_flat_free(hashtable);
+
+    /* Same load with the expected entries given on creation */
+    start_t = clock();
+    hashtable = ht_flat_create(test_size, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+    size_t capacity = ht_flat_get_capacity(hashtable);
+
+    for(int i = 0; i < test_size; i++)
+    {
+        long int entry = i;
+        ht_flat_insert(hashtable, &i, &entry, &op_error_code);
+    }
+
+    reserve_t = clock() - start_t;
+
+    if(ht_flat_get_capacity(hashtable) != capacity || ht_flat_reserve(hashtable, 2 * test_size) || ht_flat_get_capacity(hashtable) <= capacity)
+    {
+        printf("Reserve not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    /* Keep a few entries (erase at iterator never shrinks) */
+    for(flat_hashtable_tuple_t it = ht_flat_start_it(hashtable); it.key; it = ht_flat_next_it(hashtable))
+    {
+        if(*(int *)it.key >= 10)
+            ht_flat_erase_it(hashtable);
+    }
+
+    if(ht_flat_shrink_to_fit(hashtable) || ht_flat_get_capacity(hashtable) != 32 || ht_flat_get_entries(hashtable) != 10)
+    {
+        printf("Shrink to fit not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    for(int i = 0; i < 10; i++)
+    {
+        if(!ht_flat_search(hashtable, &i))
+        {
+            printf("Shrink to fit lost an entry -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    if(print_flag)
+        printf("Bulk load growing %f sec - Reserved %f sec\n", (double)grow_t / CLOCKS_PER_SEC, (double)reserve_t / CLOCKS_PER_SEC);
+
+    ht_flat_free(hashtable);
+}
+
+/* Testing of erasing at the iterator position */
+void test_erase_it(int print_flag)
+{
+    int test_size = 1000000;
+    int op_error_code = 0;
+    int visited = 0;
+
+    if(print_flag)
+        printf("\n*************** Testing erase at iterator ***************\n");
+
+    flat_hashtable_t *hashtable = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+    for(int i = 0; i < test_size; i++)
+    {
+        long int entry = i;
+        ht_flat_insert(hashtable, &i, &entry, &op_error_code);
+    }
+
+    /* Filter in place - Every element is still visited once */
+    for(flat_hashtable_tuple_t it = ht_flat_start_it(hashtable); it.key; it = ht_flat_next_it(hashtable))
+    {
+        visited++;
+
+        if(!(*(int *)it.key & 1) && ht_flat_erase_it(hashtable))
+        {
+            printf("Erase at iterator failed -> %d | Exiting...\n", *(int *)it.key);
+            exit(1);
+        }
+    }
+
+    /* Erasing twice or past the end does nothing */
+    if(visited != test_size || ht_flat_get_entries(hashtable) != test_size / 2 || ht_flat_erase_it(hashtable) != 5)
+    {
+        printf("Erase at iterator not working properly -> %d | Exiting...\n", visited);
+        exit(1);
+    }
+
+    for(int i = 0; i < test_size; i++)
+    {
+        if((ht_flat_search(hashtable, &i) != NULL) != (i & 1))
+        {
+            printf("Erase at iterator removed wrong entry -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    if(print_flag)
+        printf("Erase at iterator worked fine %d\n", visited);
+
+    ht_flat_free(hashtable);
+}
+
+/* Predicate - Erases the keys divisible by the context */
+int erase_divisible(const void *key, void *entry, void *ctx)
+{
+    return !(*(int *)key % *(int *)ctx);
+}
+
+/* Testing of the predicate based bulk erase */
+void test_erase_if(int print_flag)
+{
+    int test_size = 1000000;
+    int op_error_code = 0;
+    int divisor = 3;
+    int keep = 0;
+    clock_t start_t, end_t;
+
+    if(print_flag)
+        printf("\n*************** Testing erase if ***************\n");
+
+    flat_hashtable_t *hashtable = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+    for(int i = 0; i < test_size; i++)
+    {
+        long int entry = i;
+        ht_flat_insert(hashtable, &i, &entry, &op_error_code);
+    }
+
+    /* Erase a third of the entries in a single walk */
+    start_t = clock();
+    size_t erased = ht_flat_erase_if(hashtable, erase_divisible, &divisor);
+    end_t = clock() - start_t;
+
+    for(int i = 0; i < test_size; i++)
+    {
+        long int *entry = ht_flat_search(hashtable, &i);
+
+        if((i % divisor == 0) == (entry != NULL) || (entry && *entry != i))
+        {
+            printf("Erase if not working properly -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    /* Erasing everything ends up in the minimum size with one resize */
+    keep = 1;
+    if(erased != (test_size + divisor - 1) / divisor || ht_flat_erase_if(hashtable, erase_divisible, &keep) != test_size - erased || ht_flat_get_entries(hashtable) || ht_flat_get_capacity(hashtable) != 32)
+    {
+        printf("Erase if counts not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    if(print_flag)
+        printf("Erased %zu entries in %f sec\n", erased, (double)end_t / CLOCKS_PER_SEC);
+
+    ht_flat_free(hashtable);
+}
+
+/* Testing of the single pass find-or-insert (counters built in place) */
+void test_find_or_insert(int print_flag)
+{
+    int test_size = 1000000;
+    int distinct_keys = 1000;
+    int new_keys = 0;
+    int inserted;
+
+    if(print_flag)
+        printf("\n*************** Testing find or insert ***************\n");
+
+    flat_hashtable_t *hashtable = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &inserted);
+
+    clock_t start = clock();
+    for(int i = 0; i < test_size; i++)
+    {
+        int key = i % distinct_keys;
+        long int *counter = ht_flat_find_or_insert(hashtable, &key, &inserted);
+
+        /* Construct the entry in place */
+        if(inserted)
+        {
+            *counter = 0;
+            new_keys++;
+        }
+
+        (*counter)++;
+    }
+    clock_t end = clock() - start;
+
+    for(int i = 0; i < distinct_keys; i++)
+    {
+        long int *counter = ht_flat_search(hashtable, &i);
+
+        if(!counter || *counter != test_size / distinct_keys || new_keys != distinct_keys)
+        {
+            printf("Find or insert not working properly -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    if(print_flag)
+        printf("Avg time for find or insert: %f ns\n", ((double)end / CLOCKS_PER_SEC) / test_size * NS_TIME);
+
+    ht_flat_free(hashtable);
+}
+
+/* Testing of the two-phase (prepared) operations */
+void test_prepared(int print_flag)
+{
+    int test_size = 1000000;
+    int batch_size = 16;
+    int op_error_code = 0;
+    int found = 0;
+    ht_probe_t probes[16];
+
+    if(print_flag)
+        printf("\n*************** Testing prepared operations ***************\n");
+
+    flat_hashtable_t *hashtable = ht_flat_create(4, SMALL_4, INTEGER_4BYTE, &op_error_code);
+    flat_hashtable_t *other = ht_flat_create(4, SMALL_4, INTEGER_4BYTE, &op_error_code);
+    int *test_arr = generate_key_array(test_size, RANDOM, INTEGER_4BYTE);
+
+    /* Same handle for both tables */
+    for(int i = 0; i < test_size; i++)
+    {
+        ht_probe_t probe = ht_flat_prepare(hashtable, &test_arr[i]);
+
+        if(ht_flat_insert_prepared(hashtable, &test_arr[i], &i, probe, &op_error_code) || op_error_code ||
+           ht_flat_insert_prepared(other, &test_arr[i], &i, probe, &op_error_code) || op_error_code)
+        {
+            printf("Prepared insert not working properly -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    /* Prepare a batch ahead and then probe */
+    clock_t start = clock();
+    for(int i = 0; i < test_size; i += batch_size)
+    {
+        for(int j = 0; j < batch_size && i + j < test_size; j++)
+            probes[j] = ht_flat_prepare(hashtable, &test_arr[i + j]);
+
+        for(int j = 0; j < batch_size && i + j < test_size; j++)
+        {
+            int *entry = ht_flat_search_prepared(hashtable, &test_arr[i + j], probes[j]);
+            found += (entry && *entry == i + j);
+        }
+    }
+    clock_t end = clock() - start;
+
+    for(int i = 0; i < test_size; i += 2)
+        ht_flat_delete_prepared(other, &test_arr[i], ht_flat_prepare(other, &test_arr[i]));
+
+    /* NULL input gives an empty handle */
+    ht_probe_t empty = ht_flat_prepare(NULL, &test_arr[0]);
+    int empty_ok = !empty.hash && !empty.seed && !ht_flat_prepare(hashtable, NULL).hash;
+
+    if(!empty_ok || found != test_size || ht_flat_get_entries(other) != test_size / 2)
+    {
+        printf("Prepared operations not working properly -> %d | Exiting...\n", found);
+        exit(1);
+    }
+    else if(print_flag)
+    {
+        printf("Avg time for batched prepared search: %f ns\n", ((double)end / CLOCKS_PER_SEC) / test_size * NS_TIME);
+    }
+
+    ht_flat_free(hashtable);
+    ht_flat_free(other);
+    free(test_arr);
+}
+
+/* Testing of the bounded cache */
+void test_cache(int print_flag)
+{
+    int test_size = 100000;
+    int max_entries = 1000;
+    int hot_keys = 100;
+    int op_error_code = 0;
+
+    if(print_flag)
+        printf("\n*************** Testing bounded cache ***************\n");
+
+    flat_hashtable_t *cache = ht_flat_cache_create(max_entries, SMALL_4, INTEGER_4BYTE, &op_error_code);
+    size_t capacity = ht_flat_get_capacity(cache);
+
+    /* A stream of cold keys, with a small hot set accessed between them */
+    for(int i = 0; i < test_size; i++)
+    {
+        int hot = i % hot_keys;
+
+        if(!ht_flat_cache_get(cache, &hot))
+            ht_flat_cache_put(cache, &hot, &i);
+
+        int cold = hot_keys + i;
+        if(ht_flat_cache_put(cache, &cold, &i) || ht_flat_get_entries(cache) > max_entries)
+        {
+            printf("Cache exceeded its bounds -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    /* The hot set should have survived the cold stream */
+    int hot_found = 0;
+    for(int i = 0; i < hot_keys; i++)
+        hot_found += ht_flat_cache_get(cache, &i) != NULL;
+
+    if(hot_found != hot_keys || ht_flat_get_capacity(cache) != capacity || ht_flat_get_entries(cache) != max_entries)
+    {
+        printf("Cache eviction not working properly -> %d | Exiting...\n", hot_found);
+        exit(1);
+    }
+    else if(print_flag)
+    {
+        printf("Cache worked fine with %ld entries - %d hot keys kept\n", ht_flat_get_entries(cache), hot_found);
+    }
+
+    ht_flat_free(cache);
+}
+
+/* Testing of the byte bounded cache under churn */
+void test_cache_bytes(int print_flag)
+{
+    int test_size = 100000;
+    int hot_keys = 50;
+    int op_error_code = 0;
+    size_t max_bytes = 64 * 1024;
+
+    if(print_flag)
+        printf("\n*************** Testing byte bounded cache ***************\n");
+
+    flat_hashtable_t *cache = ht_flat_cache_create_bytes(max_bytes, SMALL_4, INTEGER_4BYTE, &op_error_code);
+    size_t capacity = ht_flat_get_capacity(cache);
+    size_t slot_cost = SMALL_4 + INTEGER_4BYTE + 1;
+
+    /* Distinct keys only - Every put after the first ones evicts */
+    int max_entries = 0;
+    for(int i = 0; i < test_size; i++)
+    {
+        if(ht_flat_cache_put(cache, &i, &i) || ht_flat_get_capacity(cache) != capacity || capacity * slot_cost > max_bytes)
+        {
+            printf("Byte bounded cache exceeded its bounds -> %d | Exiting...\n", i);
+            exit(1);
+        }
+
+        if(ht_flat_get_entries(cache) > (size_t)max_entries)
+            max_entries = ht_flat_get_entries(cache);
+    }
+
+#ifdef HT_STATS
+    /* Headroom for the tombstones - Rehashes in place are amortized over many puts */
+    ht_op_stats_t stats;
+    ht_flat_get_stats(cache, &stats);
+
+    if(stats.rehashes > test_size / (capacity / 4))
+    {
+        printf("Byte bounded cache rehashes too often -> %lu | Exiting...\n", (unsigned long)stats.rehashes);
+        exit(1);
+    }
+#endif
+
+    /* Reference every resident key - One more put then sweeps the whole clock, so only the new entry stays referenced */
+    for(int i = 0; i < test_size; i++)
+        ht_flat_cache_get(cache, &i);
+
+    ht_flat_cache_put(cache, &test_size, &test_size);
+
+    /* Reference a hot set among the resident keys */
+    int hot_found = 0, hot[50];
+    for(int i = test_size - 1; i >= 0 && hot_found < hot_keys; i--)
+    {
+        if(ht_flat_cache_get(cache, &i))
+            hot[hot_found++] = i;
+    }
+
+    /* A rehash in place keeps the reference bits */
+    if(ht_flat_reseed(cache, 0x5eed))
+    {
+        printf("Byte bounded cache reseed failed | Exiting...\n");
+        exit(1);
+    }
+
+    /* Evict exactly the unreferenced entries */
+    int cold_puts = ht_flat_get_entries(cache) - hot_keys - 1;
+    for(int i = 0; i < cold_puts; i++)
+    {
+        int cold = test_size + 1 + i;
+        ht_flat_cache_put(cache, &cold, &cold);
+    }
+
+    int hot_kept = 0;
+    for(int i = 0; i < hot_found; i++)
+        hot_kept += ht_flat_search(cache, &hot[i]) != NULL;
+
+    if(hot_found != hot_keys || hot_kept != hot_keys)
+    {
+        printf("Byte bounded cache lost its CLOCK state -> %d hot keys kept | Exiting...\n", hot_kept);
+        exit(1);
+    }
+    else if(print_flag)
+    {
+        printf("Byte bounded cache worked fine with %d entries in %zu slots - %d hot keys kept\n", max_entries, capacity, hot_kept);
+    }
+
+    ht_flat_free(cache);
+}
+
+/* Testing of the multimap operations */
+void test_multimap(int print_flag)
+{
+    int test_size = 10000;
+    int dupl_num = 5;
+    int op_error_code = 0;
+    long int *entries[5];
+
+    if(print_flag)
+        printf("\n*************** Testing multimap ***************\n");
+
+    flat_hashtable_t *hashtable = ht_flat_create(4, LONG_8BYTE, INTEGER_4BYTE, &op_error_code);
+
+    /* Key i has i % dupl_num + 1 duplicates */
+    for(int i = 0; i < test_size; i++)
+    {
+        for(long int j = 0; j <= i % dupl_num; j++)
+            ht_flat_multi_insert(hashtable, &i, &j);
+    }
+
+    for(int i = 0; i < test_size; i++)
+    {
+        long int sum = 0;
+        size_t matches = ht_flat_equal_range(hashtable, &i, (void **)entries, dupl_num);
+
+        for(size_t j = 0; j < matches; j++)
+            sum += *entries[j];
+
+        if(matches != (i % dupl_num + 1) || ht_flat_count(hashtable, &i) != matches || sum != (long)(matches * (matches - 1) / 2))
+        {
+            printf("Multimap range not working properly -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    /* Erase all duplicates of the even keys */
+    for(int i = 0; i < test_size; i += 2)
+    {
+        if(ht_flat_erase_all(hashtable, &i) != (i % dupl_num + 1) || ht_flat_count(hashtable, &i))
+        {
+            printf("Multimap erase not working properly -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    for(int i = 1; i < test_size; i += 2)
+    {
+        if(ht_flat_count(hashtable, &i) != (i % dupl_num + 1))
+        {
+            printf("Multimap erase removed other keys -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    if(print_flag)
+        printf("Multimap worked fine with %ld entries left\n", ht_flat_get_entries(hashtable));
+
+    ht_flat_free(hashtable);
+}
+
+/* Testing of the payload-free (set) variant */
+void test_set(int print_flag)
+{
+    int test_size = 100000;
+    int op_error_code = 0;
+    int iter_num = 0;
+
+    if(print_flag)
+        printf("\n*************** Testing sets ***************\n");
+
+    flat_hashtable_t *set = ht_flat_set_create(4, INTEGER_4BYTE, &op_error_code);
+
+    /* Add each key twice - Only the first one should succeed */
+    for(int i = 0; i < test_size; i++)
+    {
+        if(!ht_flat_set_add(set, &i, &op_error_code) || ht_flat_set_add(set, &i, &op_error_code) || op_error_code)
+        {
+            printf("Set add not working properly -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    /* Remove the odd keys */
+    for(int i = 1; i < test_size; i += 2)
+        ht_flat_set_remove(set, &i);
+
+    for(int i = 0; i < test_size; i++)
+    {
+        if(ht_flat_set_contains(set, &i) != !(i & 1))
+        {
+            printf("Set contains not working properly -> %d | Exiting...\n", i);
+            exit(1);
+        }
+    }
+
+    for(const int *key = ht_flat_set_start_it(set); key; key = ht_flat_set_next_it(set))
+        iter_num += !(*key & 1);
+
+    if(iter_num != test_size / 2 || ht_flat_get_entries(set) != test_size / 2)
+    {
+        printf("Set iterator not working properly -> %d | Exiting...\n", iter_num);
+        exit(1);
+    }
+    else if(print_flag)
+    {
+        printf("Set worked fine with %d keys\n", iter_num);
+        ht_flat_print_mem_usage(set);
+    }
+
+    ht_flat_free(set);
+}
+
 /* We know the size of the results */
 void analyze_results(insert_results res[TEST_TYPES][NUM_OF_KEYSIZES][NUM_OF_PAYLOADS], int is_delete)
 {
@@ -828,5 +1836,51 @@ int main()
     /* Testing iterators */
     test_iterators(1);
 
+    /* Testing sets */
+    test_set(1);
+
+    /* Testing multimap */
+    test_multimap(1);
+
+    /* Testing bounded cache */
+    test_cache(1);
+    test_cache_bytes(1);
+
+    /* Testing prepared operations */
+    test_prepared(1);
+
+    /* Testing find or insert */
+    test_find_or_insert(1);
+
+    /* Testing erase if */
+    test_erase_if(1);
+
+    /* Testing erase at iterator */
+    test_erase_it(1);
+
+    /* Testing reserve */
+    test_reserve(1);
+
+    /* Testing clear */
+    test_clear(1);
+
+    /* Testing merge */
+    test_merge(1);
+
+    /* Testing clone */
+    test_clone(1);
+
+    /* Testing seeds */
+    test_seeds(1);
+
+    /* Testing hash throughput */
+    test_hash_throughput(1);
+
+    /* Testing probe statistics */
+    test_probe_stats(1);
+
+    /* Testing operation counters */
+    test_op_stats(1);
+
     return 1;
 }
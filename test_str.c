@@ -2,6 +2,7 @@
 // Header comment place holder //
 /////////////////////////////////
 #include "node_sparse_hashtable.h"
+#include "hash_function.h"
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -43,6 +44,501 @@ size_t hash(const void *key)
     return strlen(temp_key);
 }
 
+/* Destructor function - Key and entry are allocated separately */
+void destruct_pair(void *data, void *key)
+{
+    free(data);
+    free(key);
+}
+
+/* Set destructor - Keys belong to the dictionary */
+void destruct_key(void *key)
+{
+}
+
+/* Utility - Tests the set variant over the dictionary */
+void test_set()
+{
+    int err_code;
+    int adds = 0, found = 0;
+
+    node_hashtable_t *set = ht_node_set_create(4, comp, destruct_key, hash, &err_code);
+
+    for(int i = 0; i < dict_size; i++)
+        adds += ht_node_set_add(set, dictionary[i], &err_code);
+
+    for(int i = 0; i < dict_size; i++)
+        found += ht_node_set_contains(set, dictionary[i]);
+
+    /* Set slots have no entry - The iterator returns the keys and a clone keeps them */
+    int iter_num = 0;
+    node_hashtable_t *view = ht_node_clone(set, NULL, &err_code);
+
+    for(const char *key = ht_node_set_start_it(set); key; key = ht_node_set_next_it(set))
+        iter_num += ht_node_set_contains(view, key);
+
+    /* A view of a set is still a set */
+    int ok = ht_node_set_add(view, "view_only_key", &err_code) == 1 && ht_node_set_add(view, dictionary[0], &err_code) == 0;
+    ok &= ht_node_get_entries(view) == adds + 1 && !ht_node_set_contains(set, "view_only_key");
+
+    /* Calls that store an entry are rejected */
+    ok &= ht_node_emplace(set, dictionary[0], dictionary[0], &err_code) == NULL && err_code == 2;
+    ok &= ht_node_insert(set, "set_entry_key", dictionary[0], &err_code) == NULL && err_code == 2;
+    ok &= ht_node_replace(set, dictionary[0], dictionary[0], &err_code) == NULL && err_code == 2;
+    ok &= ht_node_insert_prepared(set, "set_entry_key", dictionary[0], ht_node_prepare(set, "set_entry_key"), &err_code) == NULL && err_code == 2;
+    ok &= !ht_node_set_contains(set, "set_entry_key");
+
+    /* Duplicates in the dictionary are not added twice */
+    if(!ok || adds != ht_node_get_entries(set) || found != dict_size || iter_num != adds)
+    {
+        printf("Set not working properly -> %d | Exiting...\n", adds);
+        exit(1);
+    }
+
+    ht_node_free(view);
+
+    printf("Set {#%d Adds - #%d Found}\n", adds, found);
+    ht_node_free(set);
+}
+
+/* Destructor function - Entries on the stack */
+void destruct_none(void *data, void *key)
+{
+}
+
+/* Utility - Tests in place replacement of entries */
+void test_emplace()
+{
+    int err_code;
+    int ok = 1;
+    test_entry first = {"emplace_key", 1}, second = {"emplace_key", 2}, third = {"emplace_key", 3};
+
+    node_hashtable_t *hashtable = ht_node_create(4, comp, destruct_none, hash, &err_code);
+
+    /* Replace does not insert */
+    ok &= ht_node_replace(hashtable, first.key, &first, &err_code) == NULL && err_code == 5;
+    ok &= ht_node_emplace(hashtable, first.key, &first, &err_code) == NULL;
+    ok &= ht_node_emplace(hashtable, second.key, &second, &err_code) == &first;
+    ok &= ht_node_replace(hashtable, third.key, &third, &err_code) == &second;
+    ok &= ht_node_search(hashtable, "emplace_key") == &third;
+    ok &= ht_node_get_entries(hashtable) == 1;
+
+    if(!ok || err_code)
+    {
+        printf("Emplace not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    ht_node_free(hashtable);
+
+    /* Separately allocated equal keys - The table keeps the first key and the destructor runs on it */
+    hashtable = ht_node_create(4, comp, destruct_pair, hash, &err_code);
+
+    char *key1 = strdup("owned_key_long_enough_to_spill"), *key2 = strdup("owned_key_long_enough_to_spill"), *key3 = strdup("owned_key_long_enough_to_spill");
+    int *entry1 = malloc(sizeof(int)), *entry2 = malloc(sizeof(int)), *entry3 = malloc(sizeof(int));
+
+    ok &= ht_node_emplace(hashtable, key1, entry1, &err_code) == NULL;
+    ok &= ht_node_emplace(hashtable, key2, entry2, &err_code) == entry1;
+    ok &= ht_node_replace(hashtable, key3, entry3, &err_code) == entry2;
+    ok &= ht_node_search(hashtable, "owned_key_long_enough_to_spill") == entry3;
+
+    /* Everything not referenced by the table goes back to the user */
+    free(entry1);
+    free(entry2);
+    free(key2);
+    free(key3);
+
+    if(!ok || err_code)
+    {
+        printf("Emplace with owned keys not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    ht_node_free(hashtable);
+}
+
+/* Clone function - Deep copy of an entry along with its key */
+int clone_entry(const void *key, const void *data, void **key_copy, void **data_copy)
+{
+    test_entry *copy = malloc(sizeof(test_entry));
+
+    if(!copy)
+        return 1;
+
+    *copy = *(test_entry *)data;
+    copy->key = strdup(copy->key);
+
+    *key_copy = copy->key;
+    *data_copy = copy;
+
+    return 0;
+}
+
+/* Predicate - Erases the entries with an odd number */
+int erase_odd(const void *key, void *data, void *ctx)
+{
+    return ((test_entry *)data)->num & 1;
+}
+
+/* Utility - Tests merging of two sets with common keys */
+void test_merge()
+{
+    int err_code;
+    int found = 0;
+
+    node_hashtable_t *dst = ht_node_set_create(4, comp, destruct_key, hash, &err_code);
+    node_hashtable_t *src = ht_node_set_create(4, comp, destruct_key, hash, &err_code);
+
+    /* First two thirds and last two thirds of the dictionary */
+    for(int i = 0; i < 2 * dict_size / 3; i++)
+        ht_node_set_add(dst, dictionary[i], &err_code);
+
+    for(int i = dict_size / 3; i < dict_size; i++)
+        ht_node_set_add(src, dictionary[i], &err_code);
+
+    if(ht_node_merge(dst, src, HT_MERGE_KEEP, NULL, NULL) || ht_node_get_entries(src))
+    {
+        printf("Merge not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    for(int i = 0; i < dict_size; i++)
+        found += ht_node_set_contains(dst, dictionary[i]);
+
+    if(found != dict_size)
+    {
+        printf("Merge lost keys -> %d | Exiting...\n", found);
+        exit(1);
+    }
+
+    printf("Merge {#%zu Keys}\n", ht_node_get_entries(dst));
+    ht_node_free(dst);
+    ht_node_free(src);
+}
+
+/* Clone function - Copies the key, then fails before the entry after a number of pairs */
+int clone_fail_left = 0;
+
+int clone_failing(const void *key, const void *data, void **key_copy, void **data_copy)
+{
+    *key_copy = strdup(key);
+
+    if(!clone_fail_left--)
+        return 1;
+
+    *data_copy = malloc(sizeof(int));
+    memcpy(*data_copy, data, sizeof(int));
+
+    return 0;
+}
+
+/* Utility - Tests the views and the failures of clone */
+void test_clone()
+{
+    int err_code, ok = 1;
+    char key[32];
+
+    node_hashtable_t *hashtable = ht_node_create(4, comp, destruct_pair, hash, &err_code);
+    node_hashtable_t *other = ht_node_create(4, comp, destruct_pair, hash, &err_code);
+
+    for(int i = 0; i < 1000; i++)
+    {
+        int *entry = malloc(sizeof(int));
+        *entry = i;
+        sprintf(key, "clone_key_%d", i);
+        ht_node_insert(hashtable, strdup(key), entry, &err_code);
+    }
+
+    /* Views do not own their references - Merging them either way is rejected */
+    node_hashtable_t *view = ht_node_clone(hashtable, NULL, &err_code);
+
+    ok &= ht_node_merge(other, view, HT_MERGE_KEEP, NULL, NULL) == 2 && ht_node_merge(view, other, HT_MERGE_KEEP, NULL, NULL) == 2;
+    ok &= ht_node_get_entries(view) == 1000 && ht_node_get_entries(other) == 0;
+
+    ht_node_free(view);
+
+    /* A failed copy destructs the partial copy of its pair (checked by the leak sanitizer) */
+    clone_fail_left = 500;
+    ok &= ht_node_clone(hashtable, clone_failing, &err_code) == NULL && err_code == 3;
+
+    clone_fail_left = 1000;
+    node_hashtable_t *copy = ht_node_clone(hashtable, clone_failing, &err_code);
+    ok &= copy && ht_node_merge(other, copy, HT_MERGE_KEEP, NULL, NULL) == 0 && ht_node_get_entries(other) == 1000;
+    ok &= *(int *)ht_node_search(other, "clone_key_7") == 7 && ht_node_search(hashtable, "clone_key_7") != ht_node_search(other, "clone_key_7");
+
+    if(!ok)
+    {
+        printf("Clone views and failures not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    ht_node_free(copy);
+    ht_node_free(other);
+    ht_node_free(hashtable);
+}
+
+/* Key with a cached hash */
+typedef struct hashed_key_struct
+{
+    char *str;
+    uint64_t hash;
+} hashed_key;
+
+/* Full hash function - Returns the cached hash */
+uint64_t hash_cached(const void *key)
+{
+    return ((hashed_key *)key)->hash;
+}
+
+/* Hash function - The struct is hashed as bytes */
+size_t hash_struct(const void *key)
+{
+    (void)key;
+    return sizeof(hashed_key);
+}
+
+/* Comparator of the structs as bytes - Duplicate words are different keys */
+int comp_struct(const void *a, const void *b)
+{
+    return !memcmp(a, b, sizeof(hashed_key));
+}
+
+/* Comparator of the keys with a cached hash */
+int comp_hashed(const void *a, const void *b)
+{
+    return !strcmp(((hashed_key *)a)->str, ((hashed_key *)b)->str);
+}
+
+/* Utility - Tests the full hash mode with keys that carry their hash */
+void test_hashed()
+{
+    int err_code;
+    int found = 0, deleted = 0;
+    hashed_key *keys = malloc(dict_size * sizeof(hashed_key));
+
+    node_hashtable_t *hashtable = ht_node_create_hashed(dict_size, comp_hashed, destruct_none, hash_cached, &err_code);
+
+    for(int i = 0; i < dict_size; i++)
+    {
+        keys[i].str = dictionary[i];
+        keys[i].hash = hash_wyhash(dictionary[i], strlen(dictionary[i]), 0);
+        ht_node_insert(hashtable, &keys[i], &keys[i], &err_code);
+    }
+
+    /* Duplicate words find their first copy */
+    clock_t search_s = clock();
+
+    for(int i = 0; i < dict_size; i++)
+        found += (ht_node_search(hashtable, &keys[i]) != NULL);
+
+    clock_t search_e = clock() - search_s;
+
+    /* The seed is not used in this mode - Handles of another table are served as they are */
+    node_hashtable_t *other = ht_node_create_hashed(4, comp_hashed, destruct_none, hash_cached, &err_code);
+    ht_probe_t probe = ht_node_prepare(other, &keys[0]);
+
+    if(ht_node_reseed(hashtable, probe.seed + 1) != 0 || !ht_node_search_prepared(hashtable, &keys[0], probe))
+        found = 0;
+
+    ht_node_free(other);
+
+    /* Handles of a normal table (even with the same seed) are rehashed in this mode and vice versa */
+    other = ht_node_create(4, comp_struct, destruct_none, hash_struct, &err_code);
+    ht_node_reseed(other, probe.seed + 1);
+    size_t entries = ht_node_get_entries(hashtable);
+    int ok = 1;
+
+    for(int i = 0; i < dict_size; i++)
+    {
+        if(!ht_node_search_prepared(hashtable, &keys[i], ht_node_prepare(other, &keys[i])) ||
+           !ht_node_insert_prepared(hashtable, &keys[i], &keys[i], ht_node_prepare(other, &keys[i]), &err_code))
+            ok = 0;
+
+        ht_node_insert_prepared(other, &keys[i], &keys[i], ht_node_prepare(hashtable, &keys[i]), &err_code);
+    }
+
+    for(int i = 0; i < dict_size; i++)
+        ok &= ht_node_search(other, &keys[i]) != NULL;
+
+    if(ht_node_get_entries(hashtable) != entries || ht_node_get_entries(other) != (size_t)dict_size)
+        ok = 0;
+
+    ht_node_free(other);
+
+    for(int i = 0; i < dict_size; i += 2)
+        deleted += !ht_node_delete(hashtable, &keys[i]);
+
+    if(!ok || found != dict_size || !deleted || ht_node_search(hashtable, &keys[0]))
+    {
+        printf("Full hash mode not working properly -> %d | Exiting...\n", found);
+        exit(1);
+    }
+
+    printf("Full hash mode {#%d Searches}: %f\n", found, (double)search_e / CLOCKS_PER_SEC);
+    ht_node_free(hashtable);
+    free(keys);
+}
+
+/* Utility - Tests the span operations on keys inside a buffer */
+void test_span()
+{
+    int err_code, ok = 1;
+    char short_key[] = "span", long_key[] = "a_long_span_key_that_spills";
+    const char buf[] = "xxspan_a_long_span_key_that_spills_";
+
+    node_hashtable_t *hashtable = ht_node_set_create(4, comp, destruct_key, hash, &err_code);
+
+    ht_node_set_add(hashtable, short_key, &err_code);
+    ht_node_set_add(hashtable, long_key, &err_code);
+
+    ok &= ht_node_search_span(hashtable, &buf[2], 4) != NULL;
+    ok &= ht_node_search_span(hashtable, &buf[2], 3) == NULL;
+    ok &= ht_node_search_span(hashtable, &buf[7], strlen(long_key)) != NULL;
+    ok &= ht_node_search_span(hashtable, &buf[7], strlen(long_key) + 1) == NULL;
+    ok &= ht_node_delete_span(hashtable, &buf[7], strlen(long_key)) == 0;
+    ok &= ht_node_delete_span(hashtable, &buf[7], strlen(long_key)) == 5;
+    ok &= ht_node_set_contains(hashtable, short_key) && !ht_node_set_contains(hashtable, long_key);
+
+    if(!ok)
+    {
+        printf("Span operations not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    ht_node_free(hashtable);
+}
+
+/* Utility - Tests prepared handles reused across node tables with the same seed */
+void test_reseed()
+{
+    int err_code, ok = 1;
+    ht_probe_t probe;
+
+    node_hashtable_t *first = ht_node_create(4, comp, destruct_none, hash, &err_code);
+    node_hashtable_t *second = ht_node_create(4, comp, destruct_none, hash, &err_code);
+
+    ok &= ht_node_reseed(first, 0x5eed) == 0 && ht_node_reseed(second, 0x5eed) == 0 && ht_node_reseed(NULL, 0) == 2;
+
+    /* NULL input gives an empty handle */
+    ok &= !ht_node_prepare(NULL, dictionary[0]).hash && !ht_node_prepare(first, NULL).hash && !ht_node_prepare(first, NULL).seed;
+
+    /* Handles of the first table insert into both */
+    for(int i = 0; i < dict_size; i++)
+    {
+        probe = ht_node_prepare(first, dictionary[i]);
+        ht_node_insert_prepared(first, dictionary[i], dictionary[i], probe, &err_code);
+        ht_node_insert_prepared(second, dictionary[i], dictionary[i], probe, &err_code);
+    }
+
+    ok &= ht_node_get_entries(first) == ht_node_get_entries(second);
+
+    /* Same seed - Same handle from both tables */
+    for(int i = 0; i < dict_size && ok; i++)
+    {
+        probe = ht_node_prepare(second, dictionary[i]);
+        ok &= probe.hash == ht_node_prepare(first, dictionary[i]).hash;
+        ok &= ht_node_search_prepared(first, dictionary[i], probe) && ht_node_search_prepared(second, dictionary[i], probe);
+    }
+
+    /* Reseed with entries - Rehashed in place, older handles are still served */
+    probe = ht_node_prepare(first, dictionary[0]);
+    ok &= ht_node_reseed(first, 0xdeed) == 0 && ht_node_get_entries(first) == ht_node_get_entries(second);
+    ok &= ht_node_search_prepared(first, dictionary[0], probe) && ht_node_delete_prepared(first, dictionary[0], probe) == 0;
+
+    for(int i = 1; i < dict_size && ok; i++)
+        ok &= ht_node_search(first, dictionary[i]) != NULL || !strcmp(dictionary[i], dictionary[0]);
+
+    if(!ok)
+    {
+        printf("Node reseed not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    ht_node_free(first);
+    ht_node_free(second);
+}
+
+/* Utility - Probe statistics and operation counters over a set of the dictionary */
+void test_probe_stats()
+{
+    int err_code;
+    size_t hist_sum = 0;
+    ht_probe_stats_t stats;
+
+    node_hashtable_t *hashtable = ht_node_set_create(4, comp, destruct_key, hash, &err_code);
+
+    for(int i = 0; i < dict_size; i++)
+        ht_node_set_add(hashtable, dictionary[i], &err_code);
+
+    if(ht_node_probe_stats(hashtable, &stats) != 0 || ht_node_probe_stats(hashtable, NULL) != 2)
+    {
+        printf("Probe stats not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    for(int i = 0; i < HT_PROBE_HIST_BUCKETS; i++)
+        hist_sum += stats.probe_hist[i];
+
+    if(hist_sum != stats.entries || stats.entries != ht_node_get_entries(hashtable) || stats.max_probe < 1 || stats.max_miss_probe < 1)
+    {
+        printf("Probe stats not consistent -> %zu keys in histogram | Exiting...\n", hist_sum);
+        exit(1);
+    }
+
+    printf("Probe stats: %zu entries - probe avg %.3f max %zu - miss avg %.3f max %zu\n", stats.entries, stats.avg_probe, stats.max_probe,
+           stats.avg_miss_probe, stats.max_miss_probe);
+
+    /* Operation counters - Every word is either a new key or a duplicate */
+    ht_op_stats_t op_stats;
+
+#ifdef HT_STATS
+    if(ht_node_get_stats(hashtable, &op_stats) != 0 || op_stats.inserts != stats.entries || op_stats.inserts + op_stats.duplicates != dict_size)
+#else
+    if(ht_node_get_stats(hashtable, &op_stats) != 0 || op_stats.inserts || op_stats.duplicates)
+#endif
+    {
+        printf("Operation counters not consistent -> %lu inserts | Exiting...\n", (unsigned long)op_stats.inserts);
+        exit(1);
+    }
+
+    ht_node_free(hashtable);
+
+    /* Shrink to fit in the same capacity - Rehashed in place to clear the tombstones */
+    hashtable = ht_node_set_create(dict_size / 4, comp, destruct_key, hash, &err_code);
+    size_t capacity = ht_node_get_capacity(hashtable);
+    int added = 0, removed = 0, kept = 0;
+
+    while(added < dict_size && ht_node_get_entries(hashtable) < capacity - capacity / 8 - 1)
+        ht_node_set_add(hashtable, dictionary[added++], &err_code);
+
+    while(ht_node_get_entries(hashtable) > capacity / 2)
+        ht_node_set_remove(hashtable, dictionary[removed++]);
+
+    ht_probe_stats_t before;
+    ht_node_probe_stats(hashtable, &before);
+
+    for(int i = removed; i < added; i++)
+        kept += ht_node_set_contains(hashtable, dictionary[i]);
+
+    if(ht_node_shrink_to_fit(hashtable) || ht_node_probe_stats(hashtable, &stats) || stats.tombstones || !before.tombstones ||
+       ht_node_get_capacity(hashtable) != capacity || stats.entries != before.entries)
+    {
+        printf("Shrink to fit kept %zu tombstones (of %zu) | Exiting...\n", stats.tombstones, before.tombstones);
+        exit(1);
+    }
+
+    for(int i = removed; i < added; i++)
+        kept -= ht_node_set_contains(hashtable, dictionary[i]);
+
+    if(kept)
+    {
+        printf("Shrink to fit lost keys -> %d | Exiting...\n", kept);
+        exit(1);
+    }
+
+    ht_node_free(hashtable);
+}
+
 /* Utility - Parses testcase file */
 int parse_testcases(char *file)
 {
@@ -129,6 +625,16 @@ int main(int argc, char **argv)
     if(parse_testcases(argv[1]) == -1)
         return -1;
 
+    /* Test the set variant - Before the dictionary is handed to the hashtable */
+    test_set();
+    test_emplace();
+    test_merge();
+    test_clone();
+    test_hashed();
+    test_span();
+    test_reseed();
+    test_probe_stats();
+
     /*************************************************************************************************/
 
     /* PART 2 - Set the main parameters */
@@ -201,6 +707,52 @@ int main(int argc, char **argv)
     /* Time for searches */
     search_e = clock() - search_s;
 
+    /* Same searches in two phases - Prepare a batch ahead and then probe */
+    clock_t prepared_s = clock(), prepared_e;
+    ht_probe_t probes[16];
+    int fail_prepared = 0;
+
+    for(size_t i = 0; i < search_factor * test_size; i += 16)
+    {
+        for(size_t j = 0; j < 16 && i + j < search_factor * test_size; j++)
+            probes[j] = ht_node_prepare(hashtable, dictionary[search_idx[i + j]]);
+
+        for(size_t j = 0; j < 16 && i + j < search_factor * test_size; j++)
+        {
+            if(!ht_node_search_prepared(hashtable, dictionary[search_idx[i + j]], probes[j]))
+                fail_prepared++;
+        }
+    }
+
+    prepared_e = clock() - prepared_s;
+
+    /* Same searches on spans of a single buffer (as received) - No NUL terminators */
+    size_t *span_off = malloc((test_size + 1) * sizeof(size_t));
+    span_off[0] = 0;
+
+    for(size_t i = 0; i < test_size; i++)
+        span_off[i + 1] = span_off[i] + strlen(dictionary[i]);
+
+    char *span_buf = malloc(span_off[test_size]);
+
+    for(size_t i = 0; i < test_size; i++)
+        memcpy(&span_buf[span_off[i]], dictionary[i], span_off[i + 1] - span_off[i]);
+
+    clock_t span_s = clock(), span_e;
+    int fail_span = 0;
+
+    for(size_t i = 0; i < search_factor * test_size; i++)
+    {
+        const int idx = search_idx[i];
+
+        if(!ht_node_search_span(hashtable, &span_buf[span_off[idx]], span_off[idx + 1] - span_off[idx]))
+            fail_span++;
+    }
+
+    span_e = clock() - span_s;
+    free(span_buf);
+    free(span_off);
+
     /* Free the random access search idxs */
     free(search_idx);
 
@@ -221,15 +773,68 @@ int main(int argc, char **argv)
     /* Time for deletes */
     delete_e = clock() - delete_s;
 
+    /* Filter in place the entries with (num % 4 == 1) */
+    size_t filtered = 0;
+
+    for(node_hashtable_tuple_t it = ht_node_start_it(hashtable); it.key; it = ht_node_next_it(hashtable))
+    {
+        if(((test_entry *)it.entry)->num % 4 == 1)
+            filtered += (ht_node_erase_it(hashtable) == 0);
+    }
+
+    /* Bulk erase of the remaining odd entries */
+    size_t remaining = ht_node_get_entries(hashtable);
+    size_t erased = ht_node_erase_if(hashtable, erase_odd, NULL);
+
+    if(ht_node_get_entries(hashtable) != remaining - erased || ht_node_erase_if(hashtable, erase_odd, NULL))
+    {
+        printf("Erase if not working properly | Exiting...\n");
+        exit(1);
+    }
+
+    /* Done deleting - Release the extra capacity */
+    if(ht_node_shrink_to_fit(hashtable) || ht_node_get_load_factor(hashtable) < 0.4)
+    {
+        printf("Shrink to fit not working properly | Exiting...\n");
+        exit(1);
+    }
+
     /* Print statistics */
     ht_node_print_mem_usage(hashtable);
 
     printf("******** TIME statistics for {%s} with size {%d} ********\n", argv[1], dict_size - dupl_size);
     printf("Part 3 {#%d Insertions - #%d Insert Fails}: %f\n", dict_size - fail_insertions, fail_insertions, (double)insert_e / CLOCKS_PER_SEC);
     printf("Part 4 {#%d Searches - #%d Search Fails}: %f\n", search_factor * dict_size, fail_searches, (double)search_e / CLOCKS_PER_SEC);
+    printf("Part 4 {#%d Prepared Searches - #%d Search Fails}: %f\n", search_factor * dict_size, fail_prepared, (double)prepared_e / CLOCKS_PER_SEC);
+    printf("Part 4 {#%d Span Searches - #%d Search Fails}: %f\n", search_factor * dict_size, fail_span, (double)span_e / CLOCKS_PER_SEC);
     printf("Part 5 {#%d Deletes - #%d Delete Fails}: %f\n", dict_size / delete_factor, fail_deletes, (double)delete_e / CLOCKS_PER_SEC);
+    printf("Part 5 {#%zu Erased at iterator - #%zu Erased by predicate}\n", filtered, erased);
+
+    /* Deep and shallow snapshots of what remains */
+    node_hashtable_t *deep = ht_node_clone(hashtable, clone_entry, &err_code);
+    node_hashtable_t *shallow = ht_node_clone(hashtable, NULL, &err_code);
+
+    for(node_hashtable_tuple_t it = ht_node_start_it(hashtable); it.key; it = ht_node_next_it(hashtable))
+    {
+        test_entry *copy = ht_node_search(deep, it.key);
+
+        if(!copy || copy == it.entry || copy->num != ((test_entry *)it.entry)->num || ht_node_search(shallow, it.key) != it.entry)
+        {
+            printf("Clone not working properly | Exiting...\n");
+            exit(1);
+        }
+    }
+
+    ht_node_free(deep);
+    ht_node_free(shallow);
+
+    /* FINAL PART - Clear and free the hashtable and redundant duplicates */
+    if(ht_node_clear(hashtable, 0) || ht_node_get_entries(hashtable) || ht_node_search(hashtable, "cleared"))
+    {
+        printf("Clear not working properly | Exiting...\n");
+        exit(1);
+    }
 
-    /* FINAL PART - Free the hashtable and redundant duplicates */
     ht_node_free(hashtable);
     free_testcase(0);
 